@@ -66,6 +66,12 @@ constexpr auto bridged_interface_key = "local.bridged-network";
 constexpr auto mounts_key = "local.privileged-mounts";
 constexpr auto winterm_key = "client.apps.windows-terminal.profiles";
 constexpr auto mirror_key = "local.image.mirror"; // the mirror of simple streams
+constexpr auto native_mount_transport_key = "local.native-mounts.transport"; // Linux only
+constexpr auto virtiofs_cache_key = "local.native-mounts.virtiofs-cache";    // Linux only
+
+constexpr auto native_mount_transport_9p = "9p";
+constexpr auto native_mount_transport_virtiofs = "virtiofs";
+constexpr auto virtiofs_cache_default = "auto";
 
 constexpr auto cloud_init_file_name = "cloud-init-config.iso";
 
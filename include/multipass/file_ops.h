@@ -36,6 +36,8 @@
 
 #define MP_FILEOPS multipass::FileOps::instance()
 
+struct stat;
+
 namespace multipass
 {
 namespace fs = std::filesystem;
@@ -105,8 +107,10 @@ public:
     // posix operations
     virtual std::unique_ptr<NamedFd> open_fd(const fs::path& path, int flags, int perms) const;
     virtual int read(int fd, void* buf, size_t nbytes) const;
+    virtual int pread(int fd, void* buf, size_t nbytes, off_t offset) const;
     virtual int write(int fd, const void* buf, size_t nbytes) const;
     virtual off_t lseek(int fd, off_t offset, int whence) const;
+    virtual int fstat(int fd, struct stat* buf) const;
 
     // std operations
     virtual void open(std::fstream& stream,
@@ -125,6 +129,10 @@ public:
                       const fs::path& dist,
                       fs::copy_options copy_options,
                       std::error_code& ec) const;
+    // Create dist as a copy of the regular file src that shares its data blocks (a reflink), which
+    // is near-instant on filesystems that support it (btrfs, XFS, APFS...). Returns false, leaving
+    // nothing behind, when that is not possible. The copy overloads above try this first.
+    virtual bool clone_file(const fs::path& src, const fs::path& dist) const;
     virtual void rename(const fs::path& old_p, const fs::path& new_p) const;
     virtual bool exists(const fs::path& path) const;
     virtual bool is_symlink(const fs::path& path) const;
@@ -149,6 +157,7 @@ public:
     virtual fs::file_status status(const fs::path& path, std::error_code& err) const;
     //[[deprecated("Use non-std::error_code overload instead!")]]
     virtual fs::file_status symlink_status(const fs::path& path, std::error_code& err) const;
+    virtual fs::file_time_type last_write_time(const fs::path& path, std::error_code& err) const;
     //[[deprecated("Use non-std::error_code overload instead!")]]
     virtual std::unique_ptr<RecursiveDirIterator>
     recursive_dir_iterator(const fs::path& path, std::error_code& err) const;
@@ -21,7 +21,11 @@
 #include <multipass/image_host/base_image_host.h>
 #include <multipass/simple_streams_manifest.h>
 
+#include <QByteArray>
+
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -73,9 +77,25 @@ private:
     const SimpleStreamsManifest& manifest_from(const std::string& remote) const;
     const VMImageInfo* match_alias(const std::string& key,
                                    const SimpleStreamsManifest& manifest) const;
+    void index_manifests();
+
+    struct ParsedManifest
+    {
+        QByteArray fingerprint; // of the downloaded bytes it was parsed from
+        std::shared_ptr<const SimpleStreamsManifest> manifest;
+
+        bool operator==(const ParsedManifest&) const = default;
+    };
 
-    std::vector<std::pair<std::string, std::unique_ptr<SimpleStreamsManifest>>> manifests;
+    std::vector<std::pair<std::string, std::shared_ptr<const SimpleStreamsManifest>>> manifests;
     std::vector<std::pair<std::string, UbuntuVMImageRemote>> remotes;
+
+    // Survives clear(), so that refreshes which download the same bytes skip parsing them again
+    std::unordered_map<std::string, ParsedManifest> parsed_manifests;
+
+    // Indexes into the products of `manifests`, rebuilt along with them
+    std::unordered_map<std::string, const VMImageInfo*> products_by_full_hash; // lower-case keys
+    std::unordered_map<std::string, std::vector<const VMImageInfo*>> products_by_remote_sorted;
 };
 
 } // namespace multipass
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "logger.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace multipass
+{
+namespace logging
+{
+/*
+ * AsyncLogger - hands messages over to a wrapped logger on a background thread
+ *
+ * Callers only pay for queueing a copy of the message, so they never block on a slow sink
+ * (e.g. journald). The queue is bounded: when it is full, new messages are dropped and counted,
+ * and the count is reported through the sink once it catches up. Queued messages are flushed on
+ * destruction.
+ */
+class AsyncLogger : public Logger
+{
+public:
+    static constexpr std::size_t default_capacity = 8192;
+
+    explicit AsyncLogger(UPtr sink, std::size_t capacity = default_capacity);
+    ~AsyncLogger() override;
+
+    void log(Level level, std::string_view category, std::string_view message) const override;
+    bool accepts(Level level) const override;
+
+    std::uint64_t dropped_messages() const;
+
+private:
+    struct Entry
+    {
+        Level level;
+        std::string category;
+        std::string message;
+    };
+
+    void write_queued();
+
+    UPtr sink;
+    const std::size_t capacity;
+    mutable std::mutex mutex;
+    mutable std::condition_variable queued;
+    mutable std::deque<Entry> queue;
+    mutable std::atomic_uint64_t dropped{0};
+    bool stopping{false};
+    std::thread writer; // last, so that it starts after everything else is ready
+};
+} // namespace logging
+} // namespace multipass
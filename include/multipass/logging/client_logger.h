@@ -59,6 +59,11 @@ public:
         }
     }
 
+    bool accepts(Level level) const override
+    {
+        return level <= logging_level && server != nullptr;
+    }
+
 private:
     Level logging_level;
     grpc::ServerReaderWriterInterface<T, U>* server;
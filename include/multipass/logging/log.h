@@ -38,6 +38,7 @@ namespace logging
  * @param [in] message The message
  */
 void log_message(Level level, std::string_view category, std::string_view message);
+bool will_log(Level level); // whether a message of this level would reach any sink
 void set_logger(std::shared_ptr<Logger> logger);
 Level get_logging_level();
 Logger* get_logger(); // for tests, don't rely on it lasting
@@ -59,6 +60,9 @@ constexpr void log(Level level,
                    fmt::format_string<Args...> fmt,
                    Args&&... args)
 {
+    if (!logging::will_log(level))
+        return; // don't pay for formatting what nobody will see
+
     const auto formatted_log_msg = fmt::format(fmt, std::forward<Args>(args)...);
     logging::log_message(level, category, formatted_log_msg);
 }
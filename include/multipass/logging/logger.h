@@ -36,6 +36,11 @@ public:
     using UPtr = std::unique_ptr<Logger>;
     virtual ~Logger() = default;
     virtual void log(Level level, std::string_view category, std::string_view message) const = 0;
+    // Whether messages of this level would make it anywhere, so callers can skip formatting them
+    virtual bool accepts(Level) const
+    {
+        return true;
+    }
     Level get_logging_level()
     {
         return logging_level;
@@ -31,6 +31,7 @@ class MultiplexingLogger : public Logger
 public:
     explicit MultiplexingLogger(UPtr system_logger);
     void log(Level level, std::string_view category, std::string_view message) const override;
+    bool accepts(Level level) const override; // true if the system logger or any client wants it
     void add_logger(const Logger* logger);
     void remove_logger(const Logger* logger);
 
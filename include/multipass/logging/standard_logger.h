@@ -52,6 +52,7 @@ public:
      * @param [in] message Log message
      */
     void log(Level level, std::string_view category, std::string_view message) const override;
+    bool accepts(Level level) const override;
 
 private:
     std::ostream& target; // < Target ostream to write the log messages.
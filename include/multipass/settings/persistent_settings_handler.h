@@ -20,8 +20,10 @@
 #include "setting_spec.h"
 #include "settings_handler.h"
 
+#include <filesystem>
 #include <map>
 #include <mutex>
+#include <optional>
 
 namespace multipass
 {
@@ -44,5 +46,9 @@ private:
     QString filename;
     SettingMap settings;
     mutable std::mutex mutex;
+
+    // Values read from the file, valid for as long as the file's modification time stays the same
+    mutable std::optional<std::filesystem::file_time_type> cache_stamp;
+    mutable std::map<QString, QString> cache;
 };
 } // namespace multipass
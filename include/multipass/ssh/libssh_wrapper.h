@@ -143,6 +143,15 @@ public:
     virtual int sftp_close(sftp_file file) const;
     virtual ssize_t sftp_read(sftp_file file, void* buf, size_t count) const;
     virtual ssize_t sftp_write(sftp_file file, const void* buf, size_t count) const;
+    virtual int sftp_seek64(sftp_file file, uint64_t new_offset) const;
+    virtual ssize_t sftp_aio_begin_read(sftp_file file, size_t len, sftp_aio* aio) const;
+    virtual ssize_t sftp_aio_wait_read(sftp_aio* aio, void* buf, size_t buf_size) const;
+    virtual ssize_t sftp_aio_begin_write(sftp_file file,
+                                         const void* buf,
+                                         size_t len,
+                                         sftp_aio* aio) const;
+    virtual ssize_t sftp_aio_wait_write(sftp_aio* aio) const;
+    virtual void sftp_aio_free(sftp_aio aio) const;
     virtual int sftp_chmod(sftp_session sftp, const char* file, mode_t mode) const;
     virtual int sftp_mkdir(sftp_session sftp, const char* directory, mode_t mode) const;
     virtual int sftp_unlink(sftp_session sftp, const char* file) const;
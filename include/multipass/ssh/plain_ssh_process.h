@@ -50,7 +50,7 @@ public:
     // This method caches the exit code if we find it, but it keeps the SSHSession locked.
     bool exit_recognized(
         std::chrono::milliseconds timeout = std::chrono::milliseconds(10)) override;
-    int exit_code(std::chrono::milliseconds timeout = std::chrono::seconds(5)) override;
+    int exit_code(std::chrono::milliseconds timeout = default_exit_code_timeout) override;
 
     std::string read_std_output() override;
     std::string read_std_error() override;
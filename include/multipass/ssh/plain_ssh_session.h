@@ -58,6 +58,11 @@ public:
      */
     [[nodiscard]] bool is_connected() const override;
 
+    /**
+     * @copydoc SSHSession::is_busy
+     */
+    [[nodiscard]] bool is_busy() const override;
+
     /**
      * @copydoc SSHSession::is_moved
      */
@@ -27,6 +27,8 @@ namespace multipass
 class SSHProcess : private DisabledCopyMove
 {
 public:
+    static constexpr std::chrono::seconds default_exit_code_timeout{5};
+
     virtual ~SSHProcess() = default;
 
     /**
@@ -46,7 +48,7 @@ public:
      * @throws ExitlessSSHProcessException (or descendant) if the exit code cannot be obtained
      * within the timeout.
      */
-    virtual int exit_code(std::chrono::milliseconds timeout = std::chrono::seconds(5)) = 0;
+    virtual int exit_code(std::chrono::milliseconds timeout = default_exit_code_timeout) = 0;
 
     virtual std::string read_std_output() = 0;
     virtual std::string read_std_error() = 0;
@@ -54,6 +54,11 @@ public:
      */
     [[nodiscard]] virtual bool is_connected() const = 0;
 
+    /**
+     * @return Whether a process currently holds this session, so that exec would have to wait
+     */
+    [[nodiscard]] virtual bool is_busy() const = 0;
+
     /**
      * @return Whether this object has been moved from since the last assignment (or was last
      * assigned a moved object)
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "disabled_copy_move.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace multipass::utils
+{
+
+// A fixed set of worker threads that run queued tasks in FIFO order. Tasks must not throw.
+class ThreadPool : private DisabledCopyMove
+{
+public:
+    explicit ThreadPool(std::size_t num_threads);
+    ~ThreadPool(); // Tasks that did not start yet are dropped
+
+    void submit(std::function<void()> task);
+    std::size_t size() const;
+
+private:
+    void main();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping{false};
+};
+
+// The pool shared by the parallel_* helpers, sized after the hardware (within bounds)
+ThreadPool& shared_thread_pool();
+
+namespace detail
+{
+void run_in_parallel(std::size_t count,
+                     const std::function<void(std::size_t)>& op,
+                     std::size_t max_concurrency);
+} // namespace detail
+
+// Calls op(0) ... op(count - 1) on the shared thread pool, with at most max_concurrency of them
+// running at once. The calling thread takes part and only waits for work it could not do itself,
+// so nested calls make progress even when the pool is busy. Every op runs even if others throw;
+// once they all finish, the exception with the lowest index is rethrown.
+template <typename IndexOperation>
+void parallel_for(std::size_t count,
+                  IndexOperation&& op,
+                  std::size_t max_concurrency = std::numeric_limits<std::size_t>::max())
+{
+    detail::run_in_parallel(
+        count,
+        [&op](std::size_t index) { std::invoke(op, index); },
+        max_concurrency);
+}
+} // namespace multipass::utils
@@ -21,6 +21,7 @@
 #include <multipass/network_interface_info.h>
 #include <multipass/path.h>
 #include <multipass/singleton.h>
+#include <multipass/thread_pool.h>
 #include <multipass/virtual_machine.h>
 
 #include <fmt/base.h>
@@ -31,6 +32,8 @@
 #include <filesystem>
 #include <functional>
 #include <future>
+#include <memory>
+#include <optional>
 #include <ranges>
 #include <string>
 #include <vector>
@@ -172,30 +175,30 @@ bool is_default_constructed(const T& input_type)
 // Eventually, I went with the std::invoke_result_t based one because it makes the function
 // signature more expressive despite the fact that it makes
 // std::invoke_result_t<std::decay_t<UnaryOperation>, InputValueType> code duplicate.
+// The operations run on the shared thread pool (see parallel_for), results keep the input order.
 template <typename Container, typename UnaryOperation>
 std::vector<std::invoke_result_t<std::decay_t<UnaryOperation>, typename Container::value_type>>
 parallel_transform(const Container& input_container, UnaryOperation&& unary_op)
 {
     using InputValueType = typename Container::value_type;
     using OutputValueType = std::invoke_result_t<std::decay_t<UnaryOperation>, InputValueType>;
-    const auto num_elements = input_container.size();
 
-    // Pre-allocate space for futures
-    std::vector<std::future<OutputValueType>> futures(num_elements);
-
-    int index = 0;
+    std::vector<const InputValueType*> inputs;
+    inputs.reserve(input_container.size());
     for (const auto& item : input_container)
-    {
-        futures[index++] = std::async(std::launch::async, unary_op, std::cref(item));
-    }
+        inputs.push_back(std::addressof(item));
+
+    std::vector<std::optional<OutputValueType>> outputs(inputs.size());
+    parallel_for(inputs.size(), [&inputs, &outputs, &unary_op](std::size_t index) {
+        outputs[index].emplace(std::invoke(unary_op, *inputs[index]));
+    });
 
     std::vector<OutputValueType> results;
-    for (auto& fut : futures)
+    for (auto& item : outputs)
     {
-        auto item = fut.get();
-        if (!is_default_constructed(item))
+        if (!is_default_constructed(*item))
         {
-            results.emplace_back(std::move(item));
+            results.emplace_back(std::move(*item));
         }
     }
 
@@ -205,19 +208,13 @@ parallel_transform(const Container& input_container, UnaryOperation&& unary_op)
 template <typename Container, typename UnaryOperation>
 void parallel_for_each(Container& input_container, UnaryOperation&& unary_op)
 {
-    const auto num_elements = input_container.size();
-    std::vector<std::future<void>> empty_futures;
-    empty_futures.reserve(num_elements);
-
+    std::vector<decltype(std::addressof(*std::begin(input_container)))> items;
+    items.reserve(input_container.size());
     for (auto& item : input_container)
-    {
-        empty_futures.emplace_back(std::async(std::launch::async, unary_op, std::ref(item)));
-    }
+        items.push_back(std::addressof(item));
 
-    for (auto& empty_future : empty_futures)
-    {
-        empty_future.get();
-    }
+    parallel_for(items.size(),
+                 [&items, &unary_op](std::size_t index) { std::invoke(unary_op, *items[index]); });
 }
 } // namespace utils
 
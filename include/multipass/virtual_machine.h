@@ -86,6 +86,11 @@ public:
     virtual std::optional<IPAddress> management_ipv4() = 0;
     virtual std::vector<IPAddress> get_all_ipv4() = 0;
 
+    // For callers that batch guest queries: the command that get_all_ipv4 runs in the instance and
+    // the addresses it reports for that command's output
+    static constexpr auto all_ipv4_cmd = "ip -brief -family inet address show scope global";
+    virtual std::vector<IPAddress> all_ipv4_from(const std::string& all_ipv4_cmd_output) = 0;
+
     // careful: default param in virtual methods; be sure to keep the same value in all descendants
     virtual std::string ssh_exec(const std::string& cmd, bool whisper = false) = 0;
     virtual std::unique_ptr<SSHProcess> ssh_exec_process(const std::string& cmd,
@@ -116,6 +121,8 @@ public:
     virtual std::shared_ptr<Snapshot> get_snapshot(const std::string& name) = 0;
     virtual std::shared_ptr<Snapshot> get_snapshot(int index) = 0;
 
+    // Whether snapshots can be taken (and deleted) while the instance is running
+    virtual bool supports_live_snapshots() const = 0;
     virtual std::shared_ptr<const Snapshot> take_snapshot(const VMSpecs& specs,
                                                           const std::string& snapshot_name,
                                                           const std::string& comment) = 0;
@@ -65,7 +65,10 @@ QString cmd::Snapshot::short_help() const
 QString cmd::Snapshot::description() const
 {
     return QStringLiteral("Take a snapshot of a stopped instance that can later be restored to "
-                          "recover the current state.");
+                          "recover the current state. On the QEMU driver, running instances can "
+                          "be snapshotted too: those snapshots hold the disk alone, as it would "
+                          "be after a power cut, without data the guest did not write out yet. "
+                          "They restore to a stopped instance.");
 }
 
 mp::ParseCode cmd::Snapshot::parse_args(mp::ArgParser* parser)
@@ -49,6 +49,7 @@
 #include <multipass/settings/bool_setting_spec.h>
 #include <multipass/settings/settings.h>
 #include <multipass/snapshot.h>
+#include <multipass/thread_pool.h>
 #include <multipass/ssh/ssh_session.h>
 #include <multipass/sshfs_mount/sshfs_mount_handler.h>
 #include <multipass/top_catch_all.h>
@@ -74,7 +75,9 @@
 #include <QtConcurrent/QtConcurrent>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <functional>
 #include <optional>
 #include <stdexcept>
@@ -520,17 +523,32 @@ auto connect_rpc(mp::DaemonRpc& rpc, mp::Daemon& daemon)
     QObject::connect(&rpc, &mp::DaemonRpc::on_restart, &daemon, &mp::Daemon::restart);
     QObject::connect(&rpc, &mp::DaemonRpc::on_delete, &daemon, &mp::Daemon::delet);
     QObject::connect(&rpc, &mp::DaemonRpc::on_umount, &daemon, &mp::Daemon::umount);
-    QObject::connect(&rpc, &mp::DaemonRpc::on_version, &daemon, &mp::Daemon::version);
     QObject::connect(&rpc, &mp::DaemonRpc::on_get, &daemon, &mp::Daemon::get);
     QObject::connect(&rpc, &mp::DaemonRpc::on_set, &daemon, &mp::Daemon::set);
     QObject::connect(&rpc, &mp::DaemonRpc::on_keys, &daemon, &mp::Daemon::keys);
     QObject::connect(&rpc, &mp::DaemonRpc::on_authenticate, &daemon, &mp::Daemon::authenticate);
     QObject::connect(&rpc, &mp::DaemonRpc::on_snapshot, &daemon, &mp::Daemon::snapshot);
     QObject::connect(&rpc, &mp::DaemonRpc::on_restore, &daemon, &mp::Daemon::restore);
-    QObject::connect(&rpc, &mp::DaemonRpc::on_daemon_info, &daemon, &mp::Daemon::daemon_info);
     QObject::connect(&rpc, &mp::DaemonRpc::on_wait_ready, &daemon, &mp::Daemon::wait_ready);
-    QObject::connect(&rpc, &mp::DaemonRpc::on_zones, &daemon, &mp::Daemon::zones);
     QObject::connect(&rpc, &mp::DaemonRpc::on_zones_state, &daemon, &mp::Daemon::zones_state);
+
+    // These don't touch instance state, so they are served right away on the gRPC thread, rather
+    // than queueing behind whatever the daemon's thread is busy with
+    QObject::connect(&rpc,
+                     &mp::DaemonRpc::on_version,
+                     &daemon,
+                     &mp::Daemon::version,
+                     Qt::DirectConnection);
+    QObject::connect(&rpc,
+                     &mp::DaemonRpc::on_daemon_info,
+                     &daemon,
+                     &mp::Daemon::daemon_info,
+                     Qt::DirectConnection);
+    QObject::connect(&rpc,
+                     &mp::DaemonRpc::on_zones,
+                     &daemon,
+                     &mp::Daemon::zones,
+                     Qt::DirectConnection);
 }
 
 enum class InstanceGroup
@@ -858,6 +876,49 @@ grpc::Status cmd_vms(const LinearInstanceSelection& tgts, const VMCommand& cmd)
     return grpc::Status::OK;
 }
 
+constexpr auto max_concurrent_vm_queries = 8u;
+
+template <typename Reply>
+using VMQuery = std::function<grpc::Status(mp::VirtualMachine&, Reply&)>;
+
+// Read-only counterpart to cmd_vms, for queries that may block on each instance (e.g. over SSH).
+// Queries run on the shared thread pool, up to max_concurrent_vm_queries at once, each filling a
+// reply of its own. Replies are merged into `response` in target order, stopping after the first
+// failure, so the result is the same as running the queries in sequence.
+template <typename Reply>
+grpc::Status query_vms(const LinearInstanceSelection& tgts,
+                       const VMQuery<Reply>& query,
+                       Reply& response)
+{
+    std::vector<std::pair<grpc::Status, Reply>> results(tgts.size());
+
+    auto query_one = [&tgts, &query, &results](std::size_t i) {
+        auto vm_ptr = tgts[i]->second;
+        assert(vm_ptr && "no nulls please");
+
+        const auto start = std::chrono::steady_clock::now();
+        auto& [status, reply] = results[i];
+        status = query(*vm_ptr, reply);
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        mpl::debug(category,
+                   "Queried instance {} in {}ms",
+                   vm_ptr->get_name(),
+                   std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+    };
+
+    mp::utils::parallel_for(tgts.size(), query_one, max_concurrent_vm_queries);
+
+    for (const auto& [status, reply] : results)
+    {
+        response.MergeFrom(reply);
+        if (!status.ok())
+            return status; // Same outcome as failing early
+    }
+
+    return grpc::Status::OK;
+}
+
 std::vector<std::string> names_from(const LinearInstanceSelection& instances)
 {
     std::vector<std::string> ret;
@@ -1691,19 +1752,20 @@ try
     InfoReply response;
     config->update_prompt->populate_if_time_to_show(response.mutable_update_info());
     InstanceSnapshotsMap instance_snapshots_map;
-    bool have_mounts = false;
+    std::atomic_bool have_mounts = false;
     bool deleted = false;
     bool snapshots_only = request->snapshots();
     response.set_snapshots(snapshots_only);
 
-    auto process_snapshot_pick = [&response, &have_mounts, snapshots_only](
-                                     VirtualMachine& vm,
-                                     const SnapshotPick& snapshot_pick) {
+    auto process_snapshot_pick = [snapshots_only](VirtualMachine& vm,
+                                                  const SnapshotPick& snapshot_pick,
+                                                  InfoReply& reply,
+                                                  bool& vm_has_mounts) {
         for (const auto& snapshot_name : snapshot_pick.pick)
         {
             const auto snapshot = vm.get_snapshot(snapshot_name); // verify validity even if unused
             if (!snapshot_pick.all_or_none || !snapshots_only)
-                populate_snapshot_info(vm, snapshot, response, have_mounts);
+                populate_snapshot_info(vm, snapshot, reply, vm_has_mounts);
         }
     };
 
@@ -1712,11 +1774,11 @@ try
                                   process_snapshot_pick,
                                   snapshots_only,
                                   request,
-                                  &response,
                                   &have_mounts,
-                                  &deleted](VirtualMachine& vm) {
+                                  &deleted](VirtualMachine& vm, InfoReply& reply) {
         fmt::memory_buffer errors;
         const auto& name = vm.get_name();
+        bool vm_has_mounts = false;
 
         const auto& it = instance_snapshots_map.find(name);
         const auto& snapshot_pick = it == instance_snapshots_map.end() ? SnapshotPick{{}, true}
@@ -1724,18 +1786,18 @@ try
 
         try
         {
-            process_snapshot_pick(vm, snapshot_pick);
+            process_snapshot_pick(vm, snapshot_pick, reply, vm_has_mounts);
             if (snapshot_pick.all_or_none)
             {
                 if (snapshots_only)
                     for (const auto& snapshot : vm.view_snapshots())
-                        populate_snapshot_info(vm, snapshot, response, have_mounts);
+                        populate_snapshot_info(vm, snapshot, reply, vm_has_mounts);
                 else
                     populate_instance_info(vm,
-                                           response,
+                                           reply,
                                            request->no_runtime_information(),
                                            deleted,
-                                           have_mounts);
+                                           vm_has_mounts);
             }
         }
         catch (const NoSuchSnapshotException& e)
@@ -1743,6 +1805,9 @@ try
             add_fmt_to(errors, "{}", e.what());
         }
 
+        if (vm_has_mounts)
+            have_mounts = true;
+
         return grpc_status_for(errors);
     };
 
@@ -1757,10 +1822,11 @@ try
     {
         instance_snapshots_map = map_snapshots_to_instances(request->instance_snapshot_pairs());
 
-        if ((status = cmd_vms(instance_selection.operative_selection, fetch_detailed_report)).ok())
+        const auto query = VMQuery<InfoReply>{fetch_detailed_report};
+        if ((status = query_vms(instance_selection.operative_selection, query, response)).ok())
         {
             deleted = true;
-            status = cmd_vms(instance_selection.deleted_selection, fetch_detailed_report);
+            status = query_vms(instance_selection.deleted_selection, query, response);
         }
 
         if (have_mounts && !MP_SETTINGS.get_as<bool>(mp::mounts_key))
@@ -1793,10 +1859,10 @@ try
 
     bool deleted = false;
 
-    auto fetch_instance = [this, request, &response, &deleted](VirtualMachine& vm) {
+    auto fetch_instance = [this, request, &deleted](VirtualMachine& vm, ListReply& reply) {
         const auto& name = vm.get_name();
         auto present_state = vm.current_state();
-        auto entry = response.mutable_instance_list()->add_instances();
+        auto entry = reply.mutable_instance_list()->add_instances();
         entry->set_name(name);
         const auto zone = entry->mutable_zone();
         zone->set_name(vm.get_zone().get_name());
@@ -1842,7 +1908,7 @@ try
         return grpc::Status::OK;
     };
 
-    auto fetch_snapshot = [&response](VirtualMachine& vm) {
+    auto fetch_snapshot = [](VirtualMachine& vm, ListReply& reply) {
         fmt::memory_buffer errors;
         const auto& name = vm.get_name();
 
@@ -1850,7 +1916,7 @@ try
         {
             for (const auto& snapshot : vm.view_snapshots())
             {
-                auto entry = response.mutable_snapshot_list()->add_snapshots();
+                auto entry = reply.mutable_snapshot_list()->add_snapshots();
                 auto fundamentals = entry->mutable_fundamentals();
 
                 entry->set_name(name);
@@ -1865,13 +1931,14 @@ try
         return grpc_status_for(errors);
     };
 
-    auto cmd = request->snapshots() ? std::function(fetch_snapshot) : std::function(fetch_instance);
+    auto query = request->snapshots() ? VMQuery<ListReply>{fetch_snapshot}
+                                      : VMQuery<ListReply>{fetch_instance};
 
-    auto status = cmd_vms(select_all(operative_instances), cmd);
+    auto status = query_vms(select_all(operative_instances), query, response);
     if (status.ok())
     {
         deleted = true;
-        status = cmd_vms(select_all(deleted_instances), cmd);
+        status = query_vms(select_all(deleted_instances), query, response);
     }
 
     server->Write(response);
@@ -2640,10 +2707,13 @@ try
         assert(vm_ptr);
 
         using St = VirtualMachine::State;
-        if (auto state = vm_ptr->current_state(); state != St::off && state != St::stopped)
-            return context->set_value(
-                grpc::Status{grpc::FAILED_PRECONDITION,
-                             "Multipass can only take snapshots of stopped instances."});
+        const auto live = vm_ptr->supports_live_snapshots();
+        if (auto state = vm_ptr->current_state();
+            state != St::off && state != St::stopped && (!live || state != St::running))
+            return context->set_value(grpc::Status{
+                grpc::FAILED_PRECONDITION,
+                live ? "Multipass can only take snapshots of stopped or running instances."
+                     : "Multipass can only take snapshots of stopped instances."});
 
         auto snapshot_name = request->snapshot();
         if (!snapshot_name.empty() && !mp::utils::valid_hostname(snapshot_name))
@@ -2983,17 +3053,23 @@ void mp::Daemon::on_restart(const std::string& name)
                           std::string()));
 }
 
+// Backends report every state transition, including repeated ones, and each write rewrites and
+// syncs the whole instance DB, so only actual changes are persisted
 void mp::Daemon::persist_state_for(const std::string& name, const VirtualMachine::State& state)
 {
-    vm_instance_specs[name].state = state;
-    persist_instances();
+    auto& spec = vm_instance_specs[name];
+    if (std::exchange(spec.state, state) != state)
+        persist_instances();
 }
 
 void mp::Daemon::update_metadata_for(const std::string& name, const boost::json::object& metadata)
 {
-    vm_instance_specs[name].metadata = metadata;
-
-    persist_instances();
+    auto& spec = vm_instance_specs[name];
+    if (spec.metadata != metadata)
+    {
+        spec.metadata = metadata;
+        persist_instances();
+    }
 }
 
 boost::json::object mp::Daemon::retrieve_metadata_for(const std::string& name)
@@ -3772,7 +3848,9 @@ void mp::Daemon::populate_instance_info(VirtualMachine& vm,
     instance_info->set_os(os);
     instance_info->set_id(vm_image.id);
 
-    auto vm_specs = vm_instance_specs[name];
+    // This may run concurrently for several instances, so avoid inserting into the specs table
+    const auto spec_it = vm_instance_specs.find(name);
+    const auto vm_specs = spec_it != vm_instance_specs.end() ? spec_it->second : VMSpecs{};
 
     auto mount_info = info->mutable_mount_info();
     populate_mount_info(vm_specs.mounts, mount_info, have_mounts);
@@ -23,6 +23,7 @@
 #include <multipass/image_host/custom_image_host.h>
 #include <multipass/image_host/image_mutators.h>
 #include <multipass/image_host/ubuntu_image_host.h>
+#include <multipass/logging/async_logger.h>
 #include <multipass/logging/log.h>
 #include <multipass/logging/standard_logger.h>
 #include <multipass/name_generator.h>
@@ -107,7 +108,9 @@ std::unique_ptr<const mp::DaemonConfig> mp::DaemonConfigBuilder::build()
     if (logger == nullptr)
         logger = std::make_unique<mpl::StandardLogger>(verbosity_level);
 
-    auto multiplexing_logger = std::make_shared<mpl::MultiplexingLogger>(std::move(logger));
+    // Write to the system log on a separate thread, so that the daemon never waits on it
+    auto multiplexing_logger = std::make_shared<mpl::MultiplexingLogger>(
+        std::make_unique<mpl::AsyncLogger>(std::move(logger)));
     mpl::set_logger(multiplexing_logger);
 
     MP_UTILS.make_dir(QString::fromStdU16String(MP_PLATFORM.get_root_cert_dir().u16string()),
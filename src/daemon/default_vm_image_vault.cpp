@@ -34,6 +34,7 @@
 #include <multipass/utils/qemu_img_utils.h>
 #include <multipass/vm_image.h>
 
+#include <QDateTime>
 #include <QUrl>
 #include <QtConcurrent/QtConcurrent>
 
@@ -41,6 +42,7 @@
 #include <boost/json.hpp>
 
 #include <exception>
+#include <future>
 
 namespace mp = multipass;
 namespace mpl = multipass::logging;
@@ -72,6 +74,68 @@ void remove_source_images(const mp::VMImage& source_image, const mp::VMImage& pr
     }
 }
 
+// Hashing the compressed image runs alongside its extraction, so that verification doesn't cost
+// another full pass over a freshly downloaded file. The verification phase is reported once
+// extraction is done, while whatever is left of the hashing is awaited. The compressed file is
+// removed once both are done; an empty hash skips verification.
+std::filesystem::path extract_verified_image(const std::filesystem::path& compressed_path,
+                                             const std::string& hash,
+                                             const mp::ProgressMonitor& monitor)
+{
+    std::future<void> verification;
+    if (!hash.empty())
+    {
+        mpl::debug(category, "Verifying hash \"{}\" while extracting", hash);
+        verification = std::async(std::launch::async, [&compressed_path, &hash] {
+            MP_IMAGE_VAULT_UTILS.verify_file_hash(compressed_path, hash);
+        });
+    }
+
+    auto wait_for_verification = [&verification] {
+        if (verification.valid())
+            verification.get();
+    };
+
+    std::filesystem::path extracted_path;
+    try
+    {
+        extracted_path = MP_IMAGE_VAULT_UTILS.extract_file(compressed_path, monitor, false);
+    }
+    catch (...)
+    {
+        // A hash mismatch explains a failed extraction better than the decoder error does
+        wait_for_verification();
+        throw;
+    }
+
+    if (verification.valid())
+    {
+        mp::vault::DeleteOnException extracted_file{extracted_path};
+        monitor(mp::LaunchProgress::VERIFY, -1);
+        wait_for_verification();
+    }
+
+    QFile compressed_file{compressed_path};
+    MP_FILEOPS.remove(compressed_file);
+
+    return extracted_path;
+}
+
+// An interrupted fetch leaves a partial download in its image directory, for the next fetch of the
+// same image to resume
+bool holds_resumable_download(const QFileInfo& entry, const mp::days& days_to_expire)
+{
+    if (!entry.isDir())
+        return false;
+
+    const auto cutoff = QDateTime::currentDateTime().addDays(-days_to_expire.count());
+    const auto partials =
+        QDir{entry.absoluteFilePath()}.entryInfoList({"*.part"}, QDir::Files | QDir::Hidden);
+    return std::any_of(partials.cbegin(), partials.cend(), [&cutoff](const QFileInfo& partial) {
+        return partial.lastModified() > cutoff;
+    });
+}
+
 void delete_image_dir(const mp::Path& image_path)
 {
     QFileInfo image_file{image_path};
@@ -386,7 +450,8 @@ void mp::DefaultVMImageVault::prune_expired_images()
         }
     }
 
-    // Remove any image directories that have no corresponding database entry
+    // Remove any image directories that have no corresponding database entry, unless they hold a
+    // recent partial download
     for (const auto& entry : images_dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot))
     {
         if (std::find_if(prepared_image_records.cbegin(),
@@ -399,7 +464,8 @@ void mp::DefaultVMImageVault::prune_expired_images()
                          in_progress_image_fetches.cend(),
                          [&entry](const auto& fetch) {
                              return fetch.second.first == entry.absoluteFilePath();
-                         }))
+                         }) &&
+            !holds_resumable_download(entry, days_to_expire))
         {
             mpl::info(category,
                       "Source image {} is no longer valid. Removing it from the cache.",
@@ -571,19 +637,19 @@ mp::VMImage mp::DefaultVMImageVault::download_and_prepare_source_image(
                                     LaunchProgress::IMAGE,
                                     monitor);
 
-        if (info.verify)
+        if (source_image.image_path.extension() == ".xz")
+        {
+            source_image.image_path = extract_verified_image(source_image.image_path,
+                                                             info.verify ? id : "",
+                                                             monitor);
+        }
+        else if (info.verify)
         {
             mpl::debug(category, "Verifying hash \"{}\"", id);
             monitor(LaunchProgress::VERIFY, -1);
             MP_IMAGE_VAULT_UTILS.verify_file_hash(source_image.image_path, id);
         }
 
-        if (source_image.image_path.extension() == ".xz")
-        {
-            source_image.image_path =
-                MP_IMAGE_VAULT_UTILS.extract_file(source_image.image_path, monitor, true);
-        }
-
         auto prepared_image = prepare(source_image);
         remove_source_images(source_image, prepared_image);
 
@@ -24,6 +24,7 @@
 
 #include <yaml-cpp/yaml.h>
 
+#include <algorithm>
 #include <array>
 
 namespace mp = multipass;
@@ -43,16 +44,20 @@ public:
     static constexpr auto cpu_times_key = "cpu_times";
     static constexpr auto uptime_key = "uptime";
     static constexpr auto current_release_key = "current_release";
+    static constexpr auto all_ipv4_key = "all_ipv4";
 };
 
+// Lines of VirtualMachine::all_ipv4_cmd's output are joined with this, to fit in a YAML scalar
+constexpr auto all_ipv4_line_separator = ';';
+
 struct Cmds
 {
 private:
     static constexpr auto key_val_cmd = R"-(echo {}: "$(eval "{}")")-";
     static constexpr std::array key_cmds_pairs{
-        std::pair{Keys::loadavg_key, "cat /proc/loadavg | cut -d ' ' -f1-3"},
-        std::pair{Keys::mem_usage_key, R"(free -b | grep 'Mem:' | awk '{printf \$3}')"},
-        std::pair{Keys::mem_total_key, R"(free -b | grep 'Mem:' | awk '{printf \$2}')"},
+        std::pair{Keys::loadavg_key, "cut -d ' ' -f1-3 /proc/loadavg"},
+        std::pair{Keys::mem_usage_key, R"(free -b | awk '/^Mem:/ {printf \$3}')"},
+        std::pair{Keys::mem_total_key, R"(free -b | awk '/^Mem:/ {printf \$2}')"},
         std::pair{Keys::disk_usage_key,
                   R"(
                     bash -c '
@@ -93,7 +98,7 @@ private:
         std::pair{Keys::cpu_times_key, "head -n1 /proc/stat"},
         std::pair{Keys::uptime_key, "uptime -p | tail -c+4"},
         std::pair{Keys::current_release_key,
-                  R"(cat /etc/os-release | grep 'PRETTY_NAME' | cut -d \\\" -f2)"}};
+                  R"(grep 'PRETTY_NAME' /etc/os-release | cut -d \\\" -f2)"}};
 
     inline static const std::array cmds = [] {
         constexpr auto n = key_cmds_pairs.size();
@@ -107,11 +112,19 @@ private:
         return ret;
     }();
 
+    // Saves the separate exec that VirtualMachine::get_all_ipv4 would need
+    inline static const std::string all_ipv4_cmd =
+        fmt::format(key_val_cmd,
+                    Keys::all_ipv4_key,
+                    fmt::format(R"({} | tr '\n' '{}')",
+                                mp::VirtualMachine::all_ipv4_cmd,
+                                all_ipv4_line_separator));
+
 public:
     inline static const std::string sequential_composite_cmd =
-        fmt::to_string(fmt::join(cmds, "; "));
+        fmt::format("{}; {}", fmt::join(cmds, "; "), all_ipv4_cmd);
     inline static const std::string parallel_composite_cmd =
-        fmt::format("{} & wait", fmt::join(cmds, "& "));
+        fmt::format("{}& {} & wait", fmt::join(cmds, "& "), all_ipv4_cmd);
 };
 } // namespace
 
@@ -140,8 +153,11 @@ void mp::RuntimeInstanceInfoHelper::populate_runtime_info(mp::VirtualMachine& vm
     instance_info->set_current_release(!current_release.empty() ? current_release
                                                                 : original_release);
 
+    auto all_ipv4_output = results[Keys::all_ipv4_key].as<std::string>(/* fallback = */ "");
+    std::ranges::replace(all_ipv4_output, all_ipv4_line_separator, '\n');
+
     auto management_ip = vm.management_ipv4();
-    auto all_ipv4 = vm.get_all_ipv4();
+    auto all_ipv4 = vm.all_ipv4_from(all_ipv4_output);
 
     if (management_ip)
         instance_info->add_ipv4(management_ip->as_string());
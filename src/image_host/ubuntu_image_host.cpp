@@ -28,10 +28,11 @@
 #include <multipass/url_downloader.h>
 #include <multipass/utils.h>
 
+#include <QCryptographicHash>
 #include <QUrl>
 
 #include <algorithm>
-#include <unordered_set>
+#include <cctype>
 
 namespace mp = multipass;
 
@@ -55,6 +56,25 @@ auto key_from(const std::string& search_string)
 {
     return search_string.empty() ? "default" : search_string;
 }
+
+QByteArray fingerprint_of(const std::string& site,
+                          const QByteArray& manifest_bytes_from_official,
+                          const std::optional<QByteArray>& manifest_bytes_from_mirror)
+{
+    QCryptographicHash hash{QCryptographicHash::Sha256};
+    hash.addData(QByteArrayView{site.data(), static_cast<qsizetype>(site.size())});
+    hash.addData(manifest_bytes_from_official);
+    if (manifest_bytes_from_mirror)
+        hash.addData(*manifest_bytes_from_mirror);
+
+    return hash.result();
+}
+
+std::string to_lower(std::string str)
+{
+    std::ranges::transform(str, str.begin(), [](unsigned char c) { return std::tolower(c); });
+    return str;
+}
 } // namespace
 
 mp::UbuntuVMImageRemote::UbuntuVMImageRemote(std::string official_host,
@@ -163,18 +183,23 @@ std::vector<std::pair<std::string, mp::VMImageInfo>> mp::UbuntuVMImageHost::all_
         }
         else
         {
-            std::unordered_set<std::string> found_hashes;
+            // Products sharing the prefix are adjacent in the sorted index, with equal ids kept in
+            // manifest order
+            const auto& sorted = products_by_remote_sorted.at(remote_name);
+            auto it = std::ranges::lower_bound(sorted, key, {}, &VMImageInfo::id);
 
-            for (const auto& entry : manifest.products)
+            std::vector<const VMImageInfo*> matches;
+            for (; it != sorted.end() && (*it)->id.starts_with(key); ++it)
             {
-                const auto id = entry.id;
-                if (id.starts_with(key) && (entry.supported || query.allow_unsupported) &&
-                    found_hashes.find(id) == found_hashes.end())
-                {
-                    images.emplace_back(remote_name, entry);
-                    found_hashes.insert(id);
-                }
+                const auto& entry = **it;
+                if ((entry.supported || query.allow_unsupported) &&
+                    (matches.empty() || matches.back()->id != entry.id))
+                    matches.push_back(&entry);
             }
+
+            std::ranges::sort(matches); // back to manifest order: they all point into `products`
+            for (const auto* entry : matches)
+                images.emplace_back(remote_name, *entry);
         }
     }
 
@@ -183,15 +208,10 @@ std::vector<std::pair<std::string, mp::VMImageInfo>> mp::UbuntuVMImageHost::all_
 
 mp::VMImageInfo mp::UbuntuVMImageHost::info_for_full_hash_impl(const std::string& full_hash) const
 {
-    for (const auto& manifest : manifests)
+    if (auto it = products_by_full_hash.find(to_lower(full_hash));
+        it != products_by_full_hash.end())
     {
-        for (const auto& product : manifest.second->products)
-        {
-            if (utils::iequals(product.id, full_hash))
-            {
-                return product;
-            }
-        }
+        return *it->second;
     }
 
     throw mp::ImageNotFoundException(full_hash);
@@ -244,9 +264,19 @@ std::vector<std::string> mp::UbuntuVMImageHost::supported_remotes() const
 
 void mp::UbuntuVMImageHost::fetch_manifests(bool force_update)
 {
+    struct FetchedManifest
+    {
+        std::string remote_name;
+        ParsedManifest parsed;
+        bool reused{false};
+
+        bool operator==(const FetchedManifest&) const = default; // to drop failed remotes
+    };
+
+    // Runs concurrently for all remotes; parsed_manifests is only read here and updated below
     auto fetch_one_remote =
-        [this, force_update](const std::pair<std::string, UbuntuVMImageRemote>& remote_pair)
-        -> std::pair<std::string, std::unique_ptr<SimpleStreamsManifest>> {
+        [this, force_update](
+            const std::pair<std::string, UbuntuVMImageRemote>& remote_pair) -> FetchedManifest {
         const auto& [remote_name, remote_info] = remote_pair;
 
         try
@@ -263,15 +293,24 @@ void mp::UbuntuVMImageHost::fetch_manifests(bool force_update)
                 manifest_bytes_from_mirror = std::make_optional(bytes);
             }
 
-            auto manifest = mp::SimpleStreamsManifest::fromJson(
-                manifest_bytes_from_official,
-                manifest_bytes_from_mirror,
-                QString::fromStdString(mirror_site.value_or(official_site)),
-                [&remote_info](VMImageInfo& info) {
-                    return remote_info.apply_image_mutator(info);
-                });
+            const auto& site = mirror_site.value_or(official_site);
+            auto fingerprint =
+                fingerprint_of(site, manifest_bytes_from_official, manifest_bytes_from_mirror);
+
+            if (auto cached = parsed_manifests.find(remote_name);
+                cached != parsed_manifests.end() && cached->second.fingerprint == fingerprint)
+                return {remote_name, cached->second, true};
 
-            return std::make_pair(remote_name, std::move(manifest));
+            std::shared_ptr<const SimpleStreamsManifest> manifest =
+                mp::SimpleStreamsManifest::fromJson(
+                    manifest_bytes_from_official,
+                    manifest_bytes_from_mirror,
+                    QString::fromStdString(site),
+                    [&remote_info](VMImageInfo& info) {
+                        return remote_info.apply_image_mutator(info);
+                    });
+
+            return {remote_name, {std::move(fingerprint), std::move(manifest)}};
         }
         catch (mp::EmptyManifestException& /* e */)
         {
@@ -290,15 +329,43 @@ void mp::UbuntuVMImageHost::fetch_manifests(bool force_update)
     };
 
     auto local_manifests = mp::utils::parallel_transform(remotes, fetch_one_remote);
-    // append local_manifests to manifests
-    manifests.insert(manifests.end(),
-                     std::make_move_iterator(local_manifests.begin()),
-                     std::make_move_iterator(local_manifests.end()));
+    for (auto& [remote_name, parsed, reused] : local_manifests)
+    {
+        if (!reused && parsed.manifest)
+            parsed_manifests[remote_name] = parsed;
+
+        manifests.emplace_back(std::move(remote_name), std::move(parsed.manifest));
+    }
+
+    index_manifests();
 }
 
 void mp::UbuntuVMImageHost::clear()
 {
     manifests.clear();
+    products_by_full_hash.clear();
+    products_by_remote_sorted.clear();
+}
+
+void mp::UbuntuVMImageHost::index_manifests()
+{
+    products_by_full_hash.clear();
+    products_by_remote_sorted.clear();
+
+    for (const auto& [remote_name, manifest] : manifests)
+    {
+        if (!manifest) // the remote failed to update
+            continue;
+
+        auto& sorted = products_by_remote_sorted[remote_name];
+        for (const auto& product : manifest->products)
+        {
+            products_by_full_hash.emplace(to_lower(product.id), &product); // first one wins
+            sorted.push_back(&product);
+        }
+
+        std::ranges::stable_sort(sorted, {}, &VMImageInfo::id);
+    }
 }
 
 const mp::SimpleStreamsManifest& mp::UbuntuVMImageHost::manifest_from(
@@ -307,9 +374,7 @@ const mp::SimpleStreamsManifest& mp::UbuntuVMImageHost::manifest_from(
     const auto it = std::find_if(
         manifests.cbegin(),
         manifests.cend(),
-        [&remote](const std::pair<std::string, std::unique_ptr<SimpleStreamsManifest>>& element) {
-            return element.first == remote;
-        });
+        [&remote](const auto& element) { return element.first == remote; });
 
     if (it == manifests.cend())
         throw std::runtime_error(fmt::format("Remote \"{}\" is unknown or unreachable. If image "
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <multipass/logging/async_logger.h>
+
+#include <fmt/format.h>
+
+#include <utility>
+
+namespace mpl = multipass::logging;
+
+mpl::AsyncLogger::AsyncLogger(UPtr sink, std::size_t capacity)
+    : Logger{sink->get_logging_level()},
+      sink{std::move(sink)},
+      capacity{capacity},
+      writer{&AsyncLogger::write_queued, this}
+{
+}
+
+mpl::AsyncLogger::~AsyncLogger()
+{
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        stopping = true;
+    }
+
+    queued.notify_one();
+    writer.join();
+}
+
+void mpl::AsyncLogger::log(mpl::Level level,
+                           std::string_view category,
+                           std::string_view message) const
+{
+    if (!sink->accepts(level))
+        return;
+
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        if (queue.size() >= capacity)
+        {
+            ++dropped;
+            return;
+        }
+
+        queue.push_back({level, std::string{category}, std::string{message}});
+    }
+
+    queued.notify_one();
+}
+
+bool mpl::AsyncLogger::accepts(mpl::Level level) const
+{
+    return sink->accepts(level);
+}
+
+std::uint64_t mpl::AsyncLogger::dropped_messages() const
+{
+    return dropped;
+}
+
+void mpl::AsyncLogger::write_queued()
+{
+    std::uint64_t reported = 0;
+    std::deque<Entry> batch;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<decltype(mutex)> lock{mutex};
+            queued.wait(lock, [this] { return stopping || !queue.empty(); });
+
+            if (queue.empty()) // and stopping
+                return;
+
+            batch.swap(queue);
+        }
+
+        try
+        {
+            if (const auto newly_dropped = dropped.load() - reported; newly_dropped > 0)
+            {
+                reported += newly_dropped;
+                sink->log(Level::warning,
+                          "logging",
+                          fmt::format("Dropped {} log messages", newly_dropped));
+            }
+
+            for (const auto& entry : batch)
+                sink->log(entry.level, entry.category, entry.message);
+        }
+        catch (...)
+        {
+            // nowhere left to report this; carry on with the next batch
+        }
+
+        batch.clear();
+    }
+}
@@ -65,6 +65,12 @@ void mpl::log_message(Level level, std::string_view category, std::string_view m
         fmt::print(stderr, "[{}] [{}] {}\n", as_string(level), category, message);
 }
 
+bool mpl::will_log(Level level)
+{
+    std::shared_lock<decltype(mutex)> lock{mutex};
+    return !global_logger || global_logger->accepts(level);
+}
+
 mpl::Level mpl::get_logging_level()
 {
     if (global_logger)
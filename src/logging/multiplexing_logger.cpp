@@ -36,6 +36,15 @@ void mpl::MultiplexingLogger::log(mpl::Level level,
         logger->log(level, category, message);
 }
 
+bool mpl::MultiplexingLogger::accepts(mpl::Level level) const
+{
+    std::shared_lock<decltype(mutex)> lock{mutex};
+    return system_logger->accepts(level) ||
+           std::any_of(loggers.cbegin(), loggers.cend(), [level](auto logger) {
+               return logger->accepts(level);
+           });
+}
+
 void mpl::MultiplexingLogger::add_logger(const Logger* logger)
 {
     std::lock_guard<decltype(mutex)> lock{mutex};
@@ -39,4 +39,9 @@ void StandardLogger::log(Level level, std::string_view category, std::string_vie
         fmt::print(target, "[{}] [{}] [{}] {}\n", timestamp(), as_string(level), category, message);
     }
 }
+
+bool StandardLogger::accepts(Level level) const
+{
+    return level <= logging_level;
+}
 } // namespace multipass::logging
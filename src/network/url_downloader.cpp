@@ -35,6 +35,7 @@
 #include <QUrl>
 
 #include <memory>
+#include <stdexcept>
 
 namespace mp = multipass;
 namespace mpl = multipass::logging;
@@ -94,6 +95,20 @@ void wait_for_reply(QNetworkReply* reply, QTimer& download_timeout)
     event_loop.exec();
 }
 
+// Thrown when the server answers a request for a range (resuming a download) with something other
+// than the range or the whole resource, e.g. 416 for a partial file that is already complete
+class RangeRejectedException : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+bool rejects_range(QNetworkReply* reply)
+{
+    const auto status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
+    return status.isValid() && status.toInt() != 200 && status.toInt() != 206;
+}
+
 template <typename ProgressAction, typename DownloadAction, typename ErrorAction, typename Time>
 QByteArray download(QNetworkAccessManager* manager,
                     const Time& timeout,
@@ -103,7 +118,8 @@ QByteArray download(QNetworkAccessManager* manager,
                     ErrorAction&& on_error,
                     const std::atomic_bool& abort_download,
                     const QNetworkRequest::CacheLoadControl cache_load_control =
-                        QNetworkRequest::CacheLoadControl::PreferNetwork)
+                        QNetworkRequest::CacheLoadControl::PreferNetwork,
+                    const QList<QNetworkReply::RawHeaderPair>& extra_headers = {})
 {
     QTimer download_timeout;
     download_timeout.setInterval(timeout);
@@ -115,6 +131,8 @@ QByteArray download(QNetworkAccessManager* manager,
     request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
     request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, cache_load_control);
     request.setHeader(QNetworkRequest::UserAgentHeader, multipass_user_agent());
+    for (const auto& [name, value] : extra_headers)
+        request.setRawHeader(name, value);
 
     NetworkReplyUPtr reply{manager->get(request)};
 
@@ -149,6 +167,13 @@ QByteArray download(QNetworkAccessManager* manager,
             on_error();
             throw mp::AbortedDownloadException{error_string};
         }
+        if (!extra_headers.isEmpty() && rejects_range(reply.get()))
+        {
+            // The cache cannot help here, it only holds complete replies
+            throw RangeRejectedException{fmt::format(
+                "HTTP {}",
+                reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt())};
+        }
         if (cache_load_control == QNetworkRequest::CacheLoadControl::AlwaysCache)
         {
             on_error();
@@ -156,7 +181,8 @@ QByteArray download(QNetworkAccessManager* manager,
             mpl::error(category, "Failed to get {}: {}", adjusted_url.toString(), error_string);
             throw mp::DownloadException{adjusted_url.toString().toStdString(), error_string};
         }
-        // Log at warning level when we are going to retry
+        // Log at warning level when we are going to retry. The cache only holds complete replies,
+        // so the retry doesn't carry the extra headers (e.g. a range to resume from).
         mpl::warn(category,
                   "Failed to get {}: {} - trying cache.",
                   adjusted_url.toString(),
@@ -179,6 +205,47 @@ QByteArray download(QNetworkAccessManager* manager,
     return reply->readAll();
 }
 
+// A resumable download keeps its data in a partial file, next to a sidecar holding the validator
+// (ETag or Last-Modified) that the server sent for it
+QString partial_file_name(const QString& file_name)
+{
+    return file_name + ".part";
+}
+
+QString validator_file_name(const QString& file_name)
+{
+    return partial_file_name(file_name) + ".validator";
+}
+
+QByteArray read_validator(const QString& file_name)
+{
+    QFile validator_file{validator_file_name(file_name)};
+    return validator_file.open(QIODevice::ReadOnly) ? validator_file.readAll().trimmed()
+                                                    : QByteArray{};
+}
+
+void write_validator(const QString& file_name, const QByteArray& validator)
+{
+    QFile validator_file{validator_file_name(file_name)};
+    if (validator.isEmpty())
+        validator_file.remove();
+    else if (validator_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        validator_file.write(validator);
+}
+
+QByteArray validator_from(QNetworkReply* reply)
+{
+    if (auto etag = reply->rawHeader("ETag"); !etag.isEmpty() && !etag.startsWith("W/"))
+        return etag;
+
+    return reply->rawHeader("Last-Modified");
+}
+
+bool is_partial_content(QNetworkReply* reply)
+{
+    return reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 206;
+}
+
 template <typename Time>
 auto get_header(QNetworkAccessManager* manager,
                 const QUrl& url,
@@ -255,19 +322,42 @@ void mp::URLDownloader::download_to(const QUrl& url,
     std::atomic_bool abort_download{false};
     auto manager{MP_NETMGRFACTORY.make_network_manager(cache_dir_path)};
 
-    QFile file{file_name};
-    if (!file.open(QIODevice::ReadWrite | QIODevice::Truncate))
+    // Data goes to a partial file that is only moved into place once complete. If a transfer is
+    // interrupted, a later call (even after a restart) asks the server for the remaining range.
+    QFile file{partial_file_name(file_name)};
+    if (!file.open(QIODevice::ReadWrite))
         throw std::runtime_error(
             fmt::format("unable to write to file \"{}\"", file_name.toStdString()));
 
-    auto progress_monitor = [this, &abort_download, &monitor, progress_type, size](
-                                QNetworkReply* reply,
-                                qint64 bytes_received,
-                                qint64 bytes_total) {
+    auto validator = read_validator(file_name);
+    auto resume_offset = validator.isEmpty() ? 0 : file.size();
+
+    QList<QNetworkReply::RawHeaderPair> extra_headers;
+    if (resume_offset > 0)
+    {
+        mpl::info(category, "Resuming download of {} from byte {}", url.toString(), resume_offset);
+        extra_headers = {{"Range", QByteArray("bytes=") + QByteArray::number(resume_offset) + "-"},
+                         {"If-Range", validator}};
+    }
+
+    auto resumes = [&resume_offset](QNetworkReply* reply) {
+        return resume_offset > 0 && is_partial_content(reply);
+    };
+
+    auto progress_monitor = [&, this](QNetworkReply* reply,
+                                      qint64 bytes_received,
+                                      qint64 bytes_total) {
         static int last_progress_printed = -1;
         if (bytes_received == 0)
             return;
 
+        if (resumes(reply))
+        {
+            bytes_received += resume_offset;
+            if (bytes_total != -1)
+                bytes_total += resume_offset;
+        }
+
         if (bytes_total == -1 && size > 0)
             bytes_total = size;
 
@@ -283,8 +373,21 @@ void mp::URLDownloader::download_to(const QUrl& url,
         }
     };
 
-    auto on_download = [this, &abort_download, &file](QNetworkReply* reply,
-                                                      QTimer& download_timeout) {
+    // The first data of each reply decides whether it continues the partial file or replaces it,
+    // since the server (or the cache) may ignore the requested range
+    QNetworkReply* writing_reply = nullptr;
+    auto start_writing = [&](QNetworkReply* reply) {
+        writing_reply = reply;
+        if (resumes(reply))
+            return file.seek(file.size());
+
+        validator = validator_from(reply);
+        write_validator(file_name, validator);
+        return file.resize(0) && file.seek(0);
+    };
+
+    auto write_failed = false;
+    auto on_download = [&, this](QNetworkReply* reply, QTimer& download_timeout) {
         abort_download = abort_download || abort_downloads;
 
         if (abort_download)
@@ -293,29 +396,80 @@ void mp::URLDownloader::download_to(const QUrl& url,
             return;
         }
 
+        // Whatever comes with a refusal to resume is not part of the file
+        if (resume_offset > 0 && rejects_range(reply))
+            return;
+
         if (download_timeout.isActive())
             download_timeout.stop();
         else
             return;
 
-        if (MP_FILEOPS.write(file, reply->readAll()) < 0)
+        if ((reply != writing_reply && !start_writing(reply)) ||
+            MP_FILEOPS.write(file, reply->readAll()) < 0)
         {
             mpl::error(category, "error writing image: {}", file.errorString());
-            abort_download = true;
+            write_failed = abort_download = true;
             reply->abort();
         }
         download_timeout.start();
     };
 
-    auto on_error = [&file]() { file.remove(); };
+    // Keep what was received for a later attempt, unless it cannot be trusted to resume from
+    auto on_error = [&file, &file_name, &validator, &write_failed]() {
+        if (write_failed || validator.isEmpty() || file.size() == 0)
+        {
+            file.remove();
+            write_validator(file_name, {});
+        }
+    };
+
+    auto fetch = [&]() {
+        ::download(manager.get(),
+                   timeout,
+                   url,
+                   progress_monitor,
+                   on_download,
+                   on_error,
+                   abort_download,
+                   QNetworkRequest::CacheLoadControl::PreferNetwork,
+                   extra_headers);
+    };
 
-    ::download(manager.get(),
-               timeout,
-               url,
-               progress_monitor,
-               on_download,
-               on_error,
-               abort_download);
+    try
+    {
+        fetch();
+    }
+    catch (const RangeRejectedException& e)
+    {
+        // Retrying the same range would fail the same way, so drop what we have and start over
+        mpl::warn(category,
+                  "Cannot resume download of {}: {} - restarting it.",
+                  url.toString(),
+                  e.what());
+
+        resume_offset = 0;
+        extra_headers.clear();
+        validator.clear();
+        write_validator(file_name, validator);
+        writing_reply = nullptr;
+        if (!file.resize(0))
+            throw std::runtime_error(
+                fmt::format("unable to write to file \"{}\"", file_name.toStdString()));
+
+        fetch();
+    }
+
+    // A reply without any data leaves nothing from an earlier attempt behind
+    if (!writing_reply)
+        file.resize(0);
+
+    file.close();
+    QFile::remove(file_name);
+    if (!file.rename(file_name))
+        throw std::runtime_error(
+            fmt::format("unable to write to file \"{}\"", file_name.toStdString()));
+    write_validator(file_name, {});
 }
 
 QByteArray mp::URLDownloader::download(const QUrl& url)
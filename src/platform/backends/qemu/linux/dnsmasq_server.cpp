@@ -18,6 +18,7 @@
 #include "dnsmasq_server.h"
 #include "dnsmasq_process_spec.h"
 
+#include <multipass/file_ops.h>
 #include <multipass/format.h>
 #include <multipass/logging/log.h>
 #include <multipass/process/process.h>
@@ -38,6 +39,11 @@ namespace
 constexpr auto immediate_wait = 100; // period to wait for immediate dnsmasq failures, in ms
 constexpr auto log_category = "dnsmasq";
 
+// Modification times are only as fine as the kernel's tick, so a leases file that was written
+// this recently may change again without its stamp changing. Such files are not trusted to stay
+// parsed (like git's "racily clean" index entries).
+constexpr auto leases_stamp_granularity = std::chrono::seconds{1};
+
 auto make_dnsmasq_process(const mp::Path& data_dir,
                           const mp::BridgeSubnetList& subnets,
                           const QString& conf_file_path)
@@ -104,40 +110,84 @@ mp::DNSMasqServer::~DNSMasqServer()
 
 std::optional<mp::IPAddress> mp::DNSMasqServer::get_ip_for(const std::string& hw_addr)
 {
+    std::lock_guard lock{leases_mutex};
+    refresh_leases();
+
+    const auto it = leases.find(hw_addr);
+    if (it == leases.end())
+        return std::nullopt;
+
+    const auto now = std::chrono::system_clock::now();
+    for (const auto& [expiry, ip] : it->second)
+    {
+        // Ignore leases outside the subnets we currently serve. A version upgrade that changes
+        // the bridge layout can leave an old lease pointing at an unreachable address; skip it so
+        // we resolve the current, reachable one instead. Expired leases are skipped likewise.
+        if (ip_in_served_subnets(subnets, ip) && (!expiry || *expiry > now))
+            return ip;
+    }
+
+    return std::nullopt;
+}
+
+void mp::DNSMasqServer::refresh_leases()
+{
+    const auto path = QDir(data_dir).filePath("dnsmasq.leases").toStdString();
+
+    std::error_code err;
+    const auto stamp = MP_FILEOPS.last_write_time(path, err);
+    if (err)
+    {
+        leases_stamp.reset();
+        leases.clear();
+        return;
+    }
+
+    if (stamp == leases_stamp)
+        return;
+
     // DNSMasq leases entries consist of:
     // <lease expiration> <mac addr> <ipv4> <name> * * *
-    const auto path = QDir(data_dir).filePath("dnsmasq.leases").toStdString();
     const std::string delimiter{" "};
+    const int expiry_idx{0};
     const int hw_addr_idx{1};
     const int ipv4_idx{2};
+
+    leases.clear();
     std::ifstream leases_file{path};
     std::string line;
     while (getline(leases_file, line))
     {
         const auto fields = mp::utils::split(line, delimiter);
-        if (fields.size() > 2 && fields[hw_addr_idx] == hw_addr)
+        if (fields.size() <= 2)
+            continue;
+
+        try
         {
-            try
-            {
-                const IPAddress ip{fields[ipv4_idx]};
-                // Ignore leases outside the subnets we currently serve. A version upgrade that
-                // changes the bridge layout can leave an old lease pointing at an unreachable
-                // address; skip it so we resolve the current, reachable one instead.
-                if (ip_in_served_subnets(subnets, ip))
-                    return ip;
-                // TODO: Also check if the lease is still valid
-                // TODO: Aggregate all leases for the MAC before filtering
-            }
-            catch (const std::invalid_argument& ex) // unparseable address -> skip this line
-            {
-                mpl::debug(log_category,
-                           "Could not parse `{}` as IPv4 address: {}, ignoring lease line",
-                           fields[ipv4_idx],
-                           ex.what());
-            }
+            const IPAddress ip{fields[ipv4_idx]};
+
+            std::optional<std::chrono::system_clock::time_point> expiry;
+            if (const auto seconds = std::stoll(fields[expiry_idx]); seconds != 0)
+                expiry = std::chrono::system_clock::time_point{std::chrono::seconds{seconds}};
+
+            leases[fields[hw_addr_idx]].push_back({expiry, ip});
+        }
+        catch (const std::invalid_argument& ex) // unparseable address -> skip this line
+        {
+            mpl::debug(log_category,
+                       "Could not parse `{}` as IPv4 lease: {}, ignoring lease line",
+                       line,
+                       ex.what());
+        }
+        catch (const std::out_of_range&)
+        {
+            mpl::debug(log_category, "Lease expiry out of range: `{}`, ignoring lease line", line);
         }
     }
-    return std::nullopt;
+
+    const auto settled = std::filesystem::file_time_type::clock::now() - stamp >=
+                         leases_stamp_granularity;
+    leases_stamp = settled ? std::make_optional(stamp) : std::nullopt;
 }
 
 void mp::DNSMasqServer::release_mac(const std::string& hw_addr, const QString& bridge_name)
@@ -25,9 +25,14 @@
 
 #include <QTemporaryFile>
 
+#include <chrono>
+#include <filesystem>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace multipass
 {
@@ -51,13 +56,26 @@ protected:
     DNSMasqServer() = default; // For testing
 
 private:
+    struct Lease
+    {
+        std::optional<std::chrono::system_clock::time_point> expiry; // none for infinite leases
+        IPAddress ip;
+    };
+
     void start_dnsmasq();
+    void refresh_leases(); // requires leases_mutex
 
     const QString data_dir;
     const BridgeSubnetList subnets;
     std::unique_ptr<Process> dnsmasq_cmd;
     QMetaObject::Connection finish_connection;
     QTemporaryFile conf_file;
+
+    // The leases file as last parsed, by MAC and in file order. It is parsed again only when its
+    // modification time changes
+    std::mutex leases_mutex;
+    std::optional<std::filesystem::file_time_type> leases_stamp;
+    std::unordered_map<std::string, std::vector<Lease>> leases;
 };
 
 #define MP_DNSMASQ_SERVER_FACTORY multipass::DNSMasqServerFactory::instance()
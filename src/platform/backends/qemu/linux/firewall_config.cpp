@@ -25,7 +25,12 @@
 #include <multipass/utils/semver_compare.h>
 #include <shared/linux/process_factory.h>
 
+#include <algorithm>
+#include <map>
+#include <set>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 #include <QRegularExpression>
 
@@ -39,6 +44,8 @@ constexpr auto category = "firewall";
 // QString constants for all of the different firewall calls
 const QString iptables{QStringLiteral("iptables-legacy")};
 const QString nftables{QStringLiteral("iptables-nft")};
+const QString save_suffix{QStringLiteral("-save")};
+const QString restore_suffix{QStringLiteral("-restore")};
 const QString negate{QStringLiteral("!")};
 
 //   Different tables to use
@@ -56,20 +63,21 @@ const QString OUTPUT{QStringLiteral("OUTPUT")};
 const QString POSTROUTING{QStringLiteral("POSTROUTING")};
 const QString FORWARD{QStringLiteral("FORWARD")};
 
-//   option constants
-const QString destination{QStringLiteral("--destination")};
-const QString delete_rule{QStringLiteral("--delete")};
-const QString in_interface{QStringLiteral("--in-interface")};
-const QString append_rule{QStringLiteral("--append")};
-const QString insert_rule{QStringLiteral("--insert")};
-const QString jump{QStringLiteral("--jump")};
-const QString match{QStringLiteral("--match")};
-const QString out_interface{QStringLiteral("--out-interface")};
-const QString protocol{QStringLiteral("--protocol")};
-const QString source{QStringLiteral("--source")};
-const QString list_rules{QStringLiteral("--list-rules")};
-const QString dash_t{
-    QStringLiteral("-t")}; // Use short option for specifying table to avoid var conflicts
+//   command constants, as understood by iptables-restore
+const QString append_rule{QStringLiteral("-A")};
+const QString delete_rule{QStringLiteral("-D")};
+const QString insert_rule{QStringLiteral("-I")};
+const QString commit{QStringLiteral("COMMIT")};
+
+//   option constants, spelled the way iptables-save lists them so that rules can be compared
+const QString destination{QStringLiteral("-d")};
+const QString in_interface{QStringLiteral("-i")};
+const QString jump{QStringLiteral("-j")};
+const QString match{QStringLiteral("-m")};
+const QString out_interface{QStringLiteral("-o")};
+const QString protocol{QStringLiteral("-p")};
+const QString source{QStringLiteral("-s")};
+const QString noflush{QStringLiteral("--noflush")};
 const QString wait{QStringLiteral("--wait")};
 
 //   protocol constants
@@ -98,248 +106,332 @@ const QString icmp_port_unreachable{QStringLiteral("icmp-port-unreachable")};
 class FirewallException : public std::runtime_error
 {
 public:
-    FirewallException(const QString& issue,
-                      const QString& table,
-                      const QString& failure,
-                      const QString& output)
-        : runtime_error{fmt::format("{}; Table: {}; Failure: {}; Output: {}",
-                                    issue,
-                                    table,
-                                    failure,
-                                    output)} {};
+    FirewallException(const QString& issue, const QString& failure, const QString& output)
+        : runtime_error{fmt::format("{}; Failure: {}; Output: {}", issue, failure, output)} {};
 };
 
+struct FirewallRule
+{
+    QString table;
+    QString chain;
+    QStringList spec;
+    bool append{false};
+
+    // The rule as iptables-save lists it, without the leading command
+    QString listing() const
+    {
+        return chain + ' ' + spec.join(' ');
+    }
+};
+
+using FirewallRules = std::vector<FirewallRule>;
+
+// The rule listings found in each chain of each table, in chain order
+using FirewallState = std::map<QString, std::map<QString, QStringList>>;
+
 auto multipass_firewall_comment(const QString& bridge_name)
 {
     return QString("generated for Multipass network %1").arg(bridge_name);
 }
 
-void add_firewall_rule(const QString& firewall,
-                       const QString& table,
-                       const QString& chain,
-                       const QStringList& rule,
-                       bool append = false)
+QByteArray save_firewall_rules(const QString& firewall)
 {
-    auto process = MP_PROCFACTORY.create_process(
-        firewall,
-        QStringList() << wait << dash_t << table << (append ? append_rule : insert_rule) << chain
-                      << rule);
+    // TODO: Parse out stderr so as not to log noisy warnings from iptables-nft when legacy iptables
+    // are in use
+    auto process = MP_PROCFACTORY.create_process(firewall + save_suffix, QStringList{});
 
     if (const auto exit_state = process->execute(); !exit_state.completed_successfully())
-        throw FirewallException("Failed to set firewall rule",
-                                table,
+        throw FirewallException("Failed to get firewall rules",
                                 exit_state.failure_message(),
                                 process->read_all_standard_error());
+
+    return process->read_all_standard_output();
 }
 
-void delete_firewall_rule(const QString& firewall,
-                          const QString& table,
-                          const QStringList& chain_and_rule)
+// Apply all the commands with a single process. iptables-nft commits them all together, but
+// iptables-legacy commits each table as it reaches it, so a failure can leave earlier tables set
+void restore_firewall_rules(const QString& firewall, const QByteArray& transaction)
 {
-    auto args = QStringList() << firewall << wait << dash_t << table << delete_rule
-                              << chain_and_rule;
+    mpl::trace(category, "Applying firewall rules:\n{}", transaction);
 
     auto process =
-        MP_PROCFACTORY.create_process(QStringLiteral("sh"),
-                                      QStringList() << QStringLiteral("-c") << args.join(" "));
+        MP_PROCFACTORY.create_process(firewall + restore_suffix, QStringList{wait, noflush});
 
-    if (const auto exit_state = process->execute(); !exit_state.completed_successfully())
-        throw FirewallException("Failed to delete firewall rule",
-                                table,
-                                exit_state.failure_message(),
+    process->start();
+    if (process->wait_for_started())
+    {
+        process->write(transaction);
+        process->close_write_channel();
+    }
+
+    if (!process->wait_for_finished() || !process->process_state().completed_successfully())
+        throw FirewallException("Failed to set firewall rules",
+                                process->process_state().failure_message(),
                                 process->read_all_standard_error());
 }
 
-auto get_firewall_rules(const QString& firewall, const QString& table)
+FirewallState parse_firewall_rules(const QString& saved_rules)
 {
-    // TODO: Parse out stderr so as not to log noisy warnings from iptables-nft when legacy iptables
-    // are in use
-    auto process =
-        MP_PROCFACTORY.create_process(firewall, QStringList{wait, dash_t, table, list_rules});
+    FirewallState state;
+    QString table;
 
-    if (const auto exit_state = process->execute(); !exit_state.completed_successfully())
-        throw FirewallException("Failed to get firewall list",
-                                table,
-                                exit_state.failure_message(),
-                                process->read_all_standard_error());
+    for (const auto& line : saved_rules.split('\n'))
+    {
+        if (line.startsWith('*'))
+        {
+            table = line.mid(1).trimmed();
+        }
+        else if (line.startsWith(append_rule + ' '))
+        {
+            const auto listing = line.mid(append_rule.size() + 1).trimmed();
+            state[table][listing.section(' ', 0, 0)].append(listing);
+        }
+    }
 
-    return process->read_all_standard_output();
+    return state;
 }
 
-void set_firewall_rules(const QString& firewall,
-                        const QString& bridge_name,
-                        const mp::Subnet& cidr,
-                        const QString& comment)
+FirewallRules make_firewall_rules(const QString& bridge_name,
+                                  const mp::Subnet& cidr,
+                                  const QString& comment)
 {
     const QString cidr_str = QString::fromStdString(cidr.to_cidr());
 
     const QStringList comment_option{match,
                                      QStringLiteral("comment"),
                                      QStringLiteral("--comment"),
-                                     comment};
-
-    // Setup basic firewall overrides for DHCP/DNS
-    add_firewall_rule(firewall,
-                      filter,
-                      INPUT,
-                      QStringList() << in_interface << bridge_name << protocol << udp << dport
-                                    << port_67 << jump << ACCEPT << comment_option);
-
-    add_firewall_rule(firewall,
-                      filter,
-                      INPUT,
-                      QStringList() << in_interface << bridge_name << protocol << udp << dport
-                                    << port_53 << jump << ACCEPT << comment_option);
-
-    add_firewall_rule(firewall,
-                      filter,
-                      INPUT,
-                      QStringList() << in_interface << bridge_name << protocol << tcp << dport
-                                    << port_53 << jump << ACCEPT << comment_option);
-
-    add_firewall_rule(firewall,
-                      filter,
-                      OUTPUT,
-                      QStringList() << out_interface << bridge_name << protocol << udp << sport
-                                    << port_67 << jump << ACCEPT << comment_option);
-
-    add_firewall_rule(firewall,
-                      filter,
-                      OUTPUT,
-                      QStringList() << out_interface << bridge_name << protocol << udp << sport
-                                    << port_53 << jump << ACCEPT << comment_option);
-
-    add_firewall_rule(firewall,
-                      filter,
-                      OUTPUT,
-                      QStringList() << out_interface << bridge_name << protocol << tcp << sport
-                                    << port_53 << jump << ACCEPT << comment_option);
-
-    add_firewall_rule(firewall,
-                      mangle,
-                      POSTROUTING,
-                      QStringList() << out_interface << bridge_name << protocol << udp << dport
-                                    << port_68 << jump << QStringLiteral("CHECKSUM")
-                                    << QStringLiteral("--checksum-fill") << comment_option);
-
-    // Do not masquerade to these reserved address blocks.
-    add_firewall_rule(firewall,
-                      nat,
-                      POSTROUTING,
-                      QStringList()
-                          << source << cidr_str << destination << QStringLiteral("224.0.0.0/24")
-                          << jump << RETURN << comment_option);
-
-    add_firewall_rule(firewall,
-                      nat,
-                      POSTROUTING,
-                      QStringList() << source << cidr_str << destination
-                                    << QStringLiteral("255.255.255.255/32") << jump << RETURN
-                                    << comment_option);
-
-    // Masquerade all packets going from VMs to the LAN/Internet
-    add_firewall_rule(firewall,
-                      nat,
-                      POSTROUTING,
-                      QStringList()
-                          << source << cidr_str << negate << destination << cidr_str << protocol
-                          << tcp << jump << MASQUERADE << to_ports << port_range << comment_option);
-
-    add_firewall_rule(firewall,
-                      nat,
-                      POSTROUTING,
-                      QStringList()
-                          << source << cidr_str << negate << destination << cidr_str << protocol
-                          << udp << jump << MASQUERADE << to_ports << port_range << comment_option);
-
-    add_firewall_rule(firewall,
-                      nat,
-                      POSTROUTING,
-                      QStringList() << source << cidr_str << negate << destination << cidr_str
-                                    << jump << MASQUERADE << comment_option);
-
-    // Allow established traffic to the private subnet
-    add_firewall_rule(
-        firewall,
-        filter,
-        FORWARD,
-        QStringList() << destination << cidr_str << out_interface << bridge_name << match
-                      << QStringLiteral("conntrack") << QStringLiteral("--ctstate")
-                      << QStringLiteral("RELATED,ESTABLISHED") << jump << ACCEPT << comment_option);
-
-    // Allow outbound traffic from the private subnet
-    add_firewall_rule(firewall,
-                      filter,
-                      FORWARD,
-                      QStringList() << source << cidr_str << in_interface << bridge_name << jump
-                                    << ACCEPT << comment_option);
-
-    // Allow traffic between virtual machines
-    add_firewall_rule(firewall,
-                      filter,
-                      FORWARD,
-                      QStringList() << in_interface << bridge_name << out_interface << bridge_name
-                                    << jump << ACCEPT << comment_option);
-
-    // Reject everything else
-    add_firewall_rule(firewall,
-                      filter,
-                      FORWARD,
-                      QStringList() << in_interface << bridge_name << jump << REJECT << reject_with
-                                    << icmp_port_unreachable << comment_option,
-                      /*append=*/true);
-
-    add_firewall_rule(firewall,
-                      filter,
-                      FORWARD,
-                      QStringList() << out_interface << bridge_name << jump << REJECT << reject_with
-                                    << icmp_port_unreachable << comment_option,
-                      /*append=*/true);
+                                     '"' + comment + '"'};
+
+    return {
+        // Setup basic firewall overrides for DHCP/DNS
+        {filter,
+         INPUT,
+         QStringList() << in_interface << bridge_name << protocol << udp << match << udp << dport
+                       << port_67 << comment_option << jump << ACCEPT},
+        {filter,
+         INPUT,
+         QStringList() << in_interface << bridge_name << protocol << udp << match << udp << dport
+                       << port_53 << comment_option << jump << ACCEPT},
+        {filter,
+         INPUT,
+         QStringList() << in_interface << bridge_name << protocol << tcp << match << tcp << dport
+                       << port_53 << comment_option << jump << ACCEPT},
+        {filter,
+         OUTPUT,
+         QStringList() << out_interface << bridge_name << protocol << udp << match << udp << sport
+                       << port_67 << comment_option << jump << ACCEPT},
+        {filter,
+         OUTPUT,
+         QStringList() << out_interface << bridge_name << protocol << udp << match << udp << sport
+                       << port_53 << comment_option << jump << ACCEPT},
+        {filter,
+         OUTPUT,
+         QStringList() << out_interface << bridge_name << protocol << tcp << match << tcp << sport
+                       << port_53 << comment_option << jump << ACCEPT},
+        {mangle,
+         POSTROUTING,
+         QStringList() << out_interface << bridge_name << protocol << udp << match << udp << dport
+                       << port_68 << comment_option << jump << QStringLiteral("CHECKSUM")
+                       << QStringLiteral("--checksum-fill")},
+
+        // Do not masquerade to these reserved address blocks.
+        {nat,
+         POSTROUTING,
+         QStringList() << source << cidr_str << destination << QStringLiteral("224.0.0.0/24")
+                       << comment_option << jump << RETURN},
+        {nat,
+         POSTROUTING,
+         QStringList() << source << cidr_str << destination
+                       << QStringLiteral("255.255.255.255/32") << comment_option << jump
+                       << RETURN},
+
+        // Masquerade all packets going from VMs to the LAN/Internet
+        {nat,
+         POSTROUTING,
+         QStringList() << source << cidr_str << negate << destination << cidr_str << protocol << tcp
+                       << comment_option << jump << MASQUERADE << to_ports << port_range},
+        {nat,
+         POSTROUTING,
+         QStringList() << source << cidr_str << negate << destination << cidr_str << protocol << udp
+                       << comment_option << jump << MASQUERADE << to_ports << port_range},
+        {nat,
+         POSTROUTING,
+         QStringList() << source << cidr_str << negate << destination << cidr_str << comment_option
+                       << jump << MASQUERADE},
+
+        // Allow established traffic to the private subnet
+        {filter,
+         FORWARD,
+         QStringList() << destination << cidr_str << out_interface << bridge_name << match
+                       << QStringLiteral("conntrack") << QStringLiteral("--ctstate")
+                       << QStringLiteral("RELATED,ESTABLISHED") << comment_option << jump
+                       << ACCEPT},
+
+        // Allow outbound traffic from the private subnet
+        {filter,
+         FORWARD,
+         QStringList() << source << cidr_str << in_interface << bridge_name << comment_option
+                       << jump << ACCEPT},
+
+        // Allow traffic between virtual machines
+        {filter,
+         FORWARD,
+         QStringList() << in_interface << bridge_name << out_interface << bridge_name
+                       << comment_option << jump << ACCEPT},
+
+        // Reject everything else
+        {filter,
+         FORWARD,
+         QStringList() << in_interface << bridge_name << comment_option << jump << REJECT
+                       << reject_with << icmp_port_unreachable,
+         /*append=*/true},
+        {filter,
+         FORWARD,
+         QStringList() << out_interface << bridge_name << comment_option << jump << REJECT
+                       << reject_with << icmp_port_unreachable,
+         /*append=*/true},
+    };
 }
 
-void clear_firewall_rules_for(const QString& firewall,
-                              const QString& table,
-                              const QString& bridge_name,
-                              const mp::Subnet& cidr,
-                              const QString& comment)
+// The listings a chain ends up with once the given rules are in place: rules are inserted one at a
+// time at the top of the chain, so they end up in reverse order, followed by the appended ones
+QStringList listings_after(const FirewallRules& chain_rules)
 {
-    const QString cidr_str = QString::fromStdString(cidr.to_cidr());
-    auto rules = QString::fromUtf8(get_firewall_rules(firewall, table));
+    QStringList inserted, appended;
+    for (const auto& rule : chain_rules)
+    {
+        if (rule.append)
+            appended.append(rule.listing());
+        else
+            inserted.prepend(rule.listing());
+    }
+
+    return inserted + appended;
+}
+
+// The commands that bring our rules in each table in line with the wanted ones, by table. Chains
+// whose rules already match, in content and order, are left alone; the others have their rules
+// replaced. Tables that need no changes are left out.
+std::vector<std::pair<QString, QStringList>> firewall_changes(const FirewallState& current,
+                                                              const QString& bridge_name,
+                                                              const QString& cidr_str,
+                                                              const QString& comment,
+                                                              const FirewallRules& wanted_rules)
+{
+    const auto is_ours = [&](const QString& listing) {
+        return listing.contains(comment) || listing.contains(bridge_name) ||
+               listing.contains(cidr_str);
+    };
 
-    for (auto& rule : rules.split('\n'))
+    std::vector<std::pair<QString, QStringList>> changes;
+    for (const auto& table : firewall_tables)
     {
-        if (rule.contains(comment) || rule.contains(bridge_name) || rule.contains(cidr_str))
+        std::map<QString, QStringList> current_listings;
+        if (const auto it = current.find(table); it != current.end())
         {
-            // Remove the policy type since delete doesn't use that
-            rule.remove(0, 3);
+            for (const auto& [chain, listings] : it->second)
+                for (const auto& listing : listings)
+                    if (is_ours(listing))
+                        current_listings[chain].append(listing);
+        }
 
-            try
-            {
-                // Pass the chain and rule wholesale since we capture the whole line
-                delete_firewall_rule(firewall, table, QStringList() << rule);
-            }
-            catch (const FirewallException& e)
-            {
-                mpl::error(category, "Error deleting firewall rule '{}': {}", rule, e.what());
-            }
+        std::map<QString, FirewallRules> wanted;
+        for (const auto& rule : wanted_rules)
+            if (rule.table == table)
+                wanted[rule.chain].push_back(rule);
+
+        std::set<QString> chains;
+        for (const auto& entry : current_listings)
+            chains.insert(entry.first);
+        for (const auto& entry : wanted)
+            chains.insert(entry.first);
+
+        QStringList commands;
+        for (const auto& chain : chains)
+        {
+            const auto& chain_listings = current_listings[chain];
+            const auto& chain_rules = wanted[chain];
+            if (chain_listings == listings_after(chain_rules))
+                continue;
+
+            for (const auto& listing : chain_listings)
+                commands.append(delete_rule + ' ' + listing);
+
+            for (const auto& rule : chain_rules)
+                commands.append((rule.append ? append_rule : insert_rule) + ' ' + rule.listing());
         }
+
+        if (!commands.isEmpty())
+            changes.emplace_back(table, commands);
     }
+
+    return changes;
 }
 
-bool is_firewall_in_use(const QString& firewall)
+// Bring the rules for a bridge in line with the wanted ones, with a single restore process
+void sync_firewall_rules(const QString& firewall,
+                         const QString& bridge_name,
+                         const mp::Subnet& cidr,
+                         const QString& comment,
+                         const FirewallRules& wanted_rules)
 {
+    const QString cidr_str = QString::fromStdString(cidr.to_cidr());
+    const auto changes_from = [&](const QByteArray& saved_rules) {
+        return firewall_changes(parse_firewall_rules(QString::fromUtf8(saved_rules)),
+                                bridge_name,
+                                cidr_str,
+                                comment,
+                                wanted_rules);
+    };
+
+    const auto changes = changes_from(save_firewall_rules(firewall));
+    if (changes.empty())
+    {
+        mpl::debug(category, "Firewall rules for {} are up to date", bridge_name);
+        return;
+    }
 
-    return std::any_of(
-        firewall_tables.cbegin(),
-        firewall_tables.cend(),
-        [&firewall](const QString& table) {
-            QRegularExpression re{"^-[ARIN]"};
-            auto rule_lines = get_firewall_rules(firewall, table).split('\n');
+    QStringList transaction;
+    for (const auto& [table, commands] : changes)
+        transaction << '*' + table << commands << commit;
 
-            return std::any_of(rule_lines.cbegin(), rule_lines.cend(), [&re](const QString& line) {
-                return re.match(line).hasMatch();
-            });
+    try
+    {
+        restore_firewall_rules(firewall, (transaction.join('\n') + '\n').toUtf8());
+    }
+    catch (const FirewallException&)
+    {
+        // Tell which tables did get their changes, if any, by looking at the rules again
+        mp::top_catch_all(category, [&] {
+            const auto remaining = changes_from(save_firewall_rules(firewall));
+
+            QStringList applied;
+            for (const auto& change : changes)
+            {
+                const auto& table = change.first;
+                const auto pending = [&table](const auto& left) { return left.first == table; };
+                if (std::none_of(remaining.cbegin(), remaining.cend(), pending))
+                    applied.append(table);
+            }
+
+            if (!applied.isEmpty())
+                mpl::warn(category,
+                          "Firewall rules for {} were only partly set, in tables: {}",
+                          bridge_name,
+                          applied.join(", "));
         });
+
+        throw;
+    }
+}
+
+bool is_firewall_in_use(const QString& firewall)
+{
+    // Any rule, or any user-defined chain (those have no policy), means the firewall is in use
+    const QRegularExpression re{QStringLiteral("^(-A |:\\S+ - )"),
+                                QRegularExpression::MultilineOption};
+
+    return re.match(QString::fromUtf8(save_firewall_rules(firewall))).hasMatch();
 }
 
 // We require a >= 5.2 kernel to avoid weird conflicts with xtables and support for inet table NAT
@@ -397,8 +489,11 @@ mp::BasicFirewallConfig::BasicFirewallConfig(const QString& bridge_name, const m
 {
     try
     {
-        clear_all_firewall_rules();
-        set_firewall_rules(firewall, bridge_name, cidr, comment);
+        sync_firewall_rules(firewall,
+                            bridge_name,
+                            cidr,
+                            comment,
+                            make_firewall_rules(bridge_name, cidr, comment));
     }
     catch (const FirewallException& e)
     {
@@ -426,10 +521,7 @@ void mp::BasicFirewallConfig::verify_firewall_rules()
 
 void mp::BasicFirewallConfig::clear_all_firewall_rules()
 {
-    for (const auto& table : firewall_tables)
-    {
-        clear_firewall_rules_for(firewall, table, bridge_name, cidr, comment);
-    }
+    sync_firewall_rules(firewall, bridge_name, cidr, comment, {});
 }
 
 mp::FirewallConfig::UPtr mp::FirewallConfigFactory::make_firewall_config(
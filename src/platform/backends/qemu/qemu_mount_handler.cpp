@@ -17,12 +17,17 @@
 
 #include "qemu_mount_handler.h"
 
+#include <multipass/constants.h>
 #include <multipass/logging/log_location.h>
+#include <multipass/settings/settings.h>
 #include <multipass/ssh/ssh_process.h>
 #include <multipass/utils.h>
 
+#include <QDir>
 #include <QUuid>
 
+#include <algorithm>
+
 namespace mp = multipass;
 namespace mpl = multipass::logging;
 namespace mpu = multipass::utils;
@@ -30,6 +35,28 @@ namespace mpu = multipass::utils;
 namespace
 {
 constexpr auto category = "qemu-mount-handler";
+
+bool virtiofs_selected()
+{
+#ifdef MULTIPASS_PLATFORM_LINUX
+    return MP_SETTINGS.get(mp::native_mount_transport_key) == mp::native_mount_transport_virtiofs;
+#else
+    return false; // virtiofsd only runs on Linux
+#endif
+}
+
+bool has_virtiofs_device(const QStringList& mount_args)
+{
+    return std::any_of(mount_args.cbegin(), mount_args.cend(), [](const QString& arg) {
+        return arg.startsWith("vhost-user-fs-pci,");
+    });
+}
+
+mp::VirtiofsdProcessSpec::IdMap id_map_from(const mp::id_mappings& mappings)
+{
+    const auto map = mappings.empty() ? std::make_pair(1000, 1000) : mappings[0];
+    return {map.first, map.second == -1 ? 1000 : map.second};
+}
 } // namespace
 
 namespace multipass
@@ -40,19 +67,29 @@ QemuMountHandler::QemuMountHandler(QemuVirtualMachine* vm,
                                    VMMount mount_spec)
     : MountHandler{vm, ssh_key_provider, std::move(mount_spec), target},
       vm_mount_args{vm->modifiable_mount_args()},
+      vm_virtiofs_shares{vm->modifiable_virtiofs_shares()},
       // Create a reproducible unique mount tag for each mount. The cmd arg can only be 31 bytes
       // long so part of the uuid must be truncated. First character of tag must also be
       // alphabetical.
       tag{make_tag(target)}
 {
+    const auto uid_map = id_map_from(this->mount_spec.get_uid_mappings());
+    const auto gid_map = id_map_from(this->mount_spec.get_gid_mappings());
+
     auto state = vm->current_state();
-    if (state == VirtualMachine::State::suspended && vm_mount_args.find(tag) != vm_mount_args.end())
+    if (auto it = vm_mount_args.find(tag);
+        state == VirtualMachine::State::suspended && it != vm_mount_args.end())
     {
         mpl::info(category,
                   "Found native mount {} => {} in '{}' while suspended",
                   source,
                   target,
                   vm->get_name());
+
+        // the instance resumes with the devices it was suspended with, whatever the settings now
+        virtiofs = has_virtiofs_device(it->second.second);
+        if (virtiofs)
+            add_virtiofs_share(uid_map, gid_map);
         return;
     }
 
@@ -72,18 +109,22 @@ QemuMountHandler::QemuMountHandler(QemuVirtualMachine* vm,
               target,
               vm->get_name());
 
-    const auto uid_map = this->mount_spec.get_uid_mappings().empty()
-                             ? std::make_pair(1000, 1000)
-                             : this->mount_spec.get_uid_mappings()[0];
-    const auto gid_map = this->mount_spec.get_gid_mappings().empty()
-                             ? std::make_pair(1000, 1000)
-                             : this->mount_spec.get_gid_mappings()[0];
-    const auto uid_arg = QString("uid_map=%1:%2,")
-                             .arg(uid_map.first)
-                             .arg(uid_map.second == -1 ? 1000 : uid_map.second);
-    const auto gid_arg = QString{"gid_map=%1:%2,"}
-                             .arg(gid_map.first)
-                             .arg(gid_map.second == -1 ? 1000 : gid_map.second);
+    if (virtiofs = virtiofs_selected(); virtiofs)
+    {
+        mpl::debug(category, "Serving {} over virtio-fs", source);
+        const auto qtag = QString::fromStdString(tag);
+        const auto& share = add_virtiofs_share(uid_map, gid_map);
+        vm_mount_args[tag] = {
+            source,
+            {"-chardev",
+             QString{"socket,id=%1,path=%2"}.arg(qtag, share.socket_path()),
+             "-device",
+             QString{"vhost-user-fs-pci,queue-size=1024,chardev=%1,tag=%1"}.arg(qtag)}};
+        return;
+    }
+
+    const auto uid_arg = QString("uid_map=%1:%2,").arg(uid_map.first).arg(uid_map.second);
+    const auto gid_arg = QString{"gid_map=%1:%2,"}.arg(gid_map.first).arg(gid_map.second);
     vm_mount_args[tag] = {source,
                           {"-virtfs",
                            QString::fromStdString(fmt::format(
@@ -97,14 +138,17 @@ QemuMountHandler::QemuMountHandler(QemuVirtualMachine* vm,
 bool QemuMountHandler::is_active()
 try
 {
-    return active &&
-           !vm->ssh_exec_process(fmt::format("findmnt --type 9p | grep '{} {}'", target, tag))
-                ->exit_code();
+    return active && !vm->ssh_exec_process(fmt::format("findmnt --type {} | grep '{} {}'",
+                                                       filesystem_type(),
+                                                       target,
+                                                       tag))
+                          ->exit_code();
 }
 catch (const std::exception& e)
 {
     mpl::warn(category,
-              "Failed checking 9p mount \"{}\" in instance '{}': {}",
+              "Failed checking {} mount \"{}\" in instance '{}': {}",
+              filesystem_type(),
               target,
               vm->get_name(),
               e.what());
@@ -129,11 +173,15 @@ void QemuMountHandler::activate_impl(ServerVariant, std::chrono::milliseconds)
         mpu::set_owner_for(*session, leading, missing, default_uid, default_gid);
     }
 
-    MP_UTILS.run_in_ssh_session(
-        *session,
-        fmt::format("sudo mount -t 9p {} {} -o trans=virtio,version=9p2000.L,msize=536870912",
-                    tag,
-                    target));
+    if (virtiofs)
+        MP_UTILS.run_in_ssh_session(*session,
+                                    fmt::format("sudo mount -t virtiofs {} {}", tag, target));
+    else
+        MP_UTILS.run_in_ssh_session(
+            *session,
+            fmt::format("sudo mount -t 9p {} {} -o trans=virtio,version=9p2000.L,msize=536870912",
+                        tag,
+                        target));
 }
 
 void QemuMountHandler::deactivate_impl(bool force)
@@ -157,6 +205,34 @@ QemuMountHandler::~QemuMountHandler()
 {
     deactivate(/*force=*/true);
     vm_mount_args.erase(tag);
+    vm_virtiofs_shares.erase(tag);
+}
+
+const VirtiofsdProcessSpec& QemuMountHandler::add_virtiofs_share(
+    const VirtiofsdProcessSpec::IdMap& uid_map,
+    const VirtiofsdProcessSpec::IdMap& gid_map)
+{
+    const auto qtag = QString::fromStdString(tag);
+
+    // Tags only depend on the target, so other instances may use the same one
+    const auto socket_name = make_tag(fmt::format("{}:{}", vm->get_name(), target)) + ".sock";
+
+    vm_virtiofs_shares.erase(tag);
+    return vm_virtiofs_shares
+        .emplace(tag,
+                 VirtiofsdProcessSpec{qtag,
+                                      QString::fromStdString(source),
+                                      QDir{VirtiofsdProcessSpec::socket_dir()}.filePath(
+                                          QString::fromStdString(socket_name)),
+                                      MP_SETTINGS.get(mp::virtiofs_cache_key),
+                                      uid_map,
+                                      gid_map})
+        .first->second;
+}
+
+const char* QemuMountHandler::filesystem_type() const
+{
+    return virtiofs ? "virtiofs" : "9p";
 }
 
 std::string QemuMountHandler::make_tag(const std::string& seed)
@@ -39,8 +39,14 @@ public:
     static std::string make_tag(const std::string& seed);
 
 private:
+    const VirtiofsdProcessSpec& add_virtiofs_share(const VirtiofsdProcessSpec::IdMap& uid_map,
+                                                   const VirtiofsdProcessSpec::IdMap& gid_map);
+    const char* filesystem_type() const;
+
     QemuVirtualMachine::MountArgs& vm_mount_args;
+    QemuVirtualMachine::VirtiofsShares& vm_virtiofs_shares;
     std::string tag;
+    bool virtiofs{false}; // whether this mount uses virtio-fs rather than 9p
 };
 
 } // namespace multipass
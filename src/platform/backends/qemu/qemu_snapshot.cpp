@@ -77,6 +77,7 @@ mp::QemuSnapshot::QemuSnapshot(const std::string& name,
                                QemuVirtualMachine& vm,
                                VirtualMachineDescription& desc)
     : BaseSnapshot{name, comment, cloud_init_instance_id, std::move(parent), specs, vm},
+      vm{vm},
       desc{desc},
       image_path{desc.image.image_path}
 {
@@ -85,7 +86,7 @@ mp::QemuSnapshot::QemuSnapshot(const std::string& name,
 mp::QemuSnapshot::QemuSnapshot(const std::filesystem::path& filename,
                                QemuVirtualMachine& vm,
                                VirtualMachineDescription& desc)
-    : BaseSnapshot{filename, vm, desc}, desc{desc}, image_path{desc.image.image_path}
+    : BaseSnapshot{filename, vm, desc}, vm{vm}, desc{desc}, image_path{desc.image.image_path}
 {
 }
 
@@ -95,26 +96,40 @@ void mp::QemuSnapshot::capture_impl()
 
     // Avoid creating more than one snapshot with the same tag (creation would succeed, but we'd
     // then be unable to identify the snapshot by tag)
-    if (backend::instance_image_has_snapshot(image_path, tag))
+    if (vm.image_has_snapshot(tag))
         throw std::runtime_error{fmt::format(
             "A snapshot with the same tag already exists in the image. Image: {}; tag: {})",
             image_path,
             tag)};
 
-    mp::backend::checked_exec_qemu_img(make_capture_spec(tag, image_path));
+    if (vm.image_in_use())
+        vm.take_live_image_snapshot(tag);
+    else
+        mp::backend::checked_exec_qemu_img(make_capture_spec(tag, image_path));
+
+    vm.record_image_snapshot(tag, true);
 }
 
 void mp::QemuSnapshot::erase_impl()
 {
     const auto& tag = get_id();
-    if (backend::instance_image_has_snapshot(image_path, tag))
-        mp::backend::checked_exec_qemu_img(make_delete_spec(tag, image_path));
+    if (vm.image_has_snapshot(tag))
+    {
+        if (vm.image_in_use())
+            vm.delete_live_image_snapshot(tag);
+        else
+            mp::backend::checked_exec_qemu_img(make_delete_spec(tag, image_path));
+
+        vm.record_image_snapshot(tag, false);
+    }
     else
+    {
         mpl::warn(BaseSnapshot::get_name(),
                   "Could not find the underlying QEMU snapshot. Assuming it is already "
                   "gone. Image: {}; tag: {}",
                   image_path,
                   tag);
+    }
 }
 
 void mp::QemuSnapshot::apply_impl()
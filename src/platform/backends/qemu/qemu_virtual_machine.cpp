@@ -32,6 +32,7 @@
 #include <multipass/memory_size.h>
 #include <multipass/platform.h>
 #include <multipass/top_catch_all.h>
+#include <multipass/utils.h>
 #include <multipass/utils/qemu_img_utils.h>
 #include <multipass/vm_mount.h>
 #include <multipass/vm_status_monitor.h>
@@ -42,6 +43,8 @@
 #include <QString>
 #include <QTemporaryFile>
 
+#include <scope_guard.hpp>
+
 #include <cassert>
 
 namespace mp = multipass;
@@ -52,6 +55,9 @@ using namespace std::chrono_literals;
 namespace
 {
 constexpr auto suspend_tag = "suspend";
+constexpr auto suspend_capabilities_id = "suspend-capabilities";
+constexpr auto suspend_migrate_id = "suspend-migrate";
+constexpr auto resume_migrate_id = "resume-migrate";
 constexpr auto machine_type_key = "machine_type";
 constexpr auto arguments_key = "arguments";
 constexpr auto mount_data_key = "mount_data";
@@ -59,6 +65,7 @@ constexpr auto mount_source_key = "source";
 constexpr auto mount_arguments_key = "arguments";
 
 constexpr int kill_process_timeout = 5000; // unit: ms, 5 seconds timeout for killing the process
+constexpr auto qmp_reply_timeout = 1min;
 
 QString get_vm_machine(const boost::json::value& metadata)
 {
@@ -109,9 +116,11 @@ auto make_qemu_process(const mp::VirtualMachineDescription& desc,
     if (resume_metadata)
     {
         const auto& data = resume_metadata.value();
-        resume_data = mp::QemuVMProcessSpec::ResumeData{suspend_tag,
-                                                        get_vm_machine(data),
-                                                        get_arguments(data)};
+        resume_data = mp::QemuVMProcessSpec::ResumeData{
+            suspend_tag,
+            get_vm_machine(data),
+            get_arguments(data),
+            MP_FILEOPS.exists(mp::QemuVMProcessSpec::suspend_state_path(desc))};
     }
 
     auto process_spec =
@@ -129,6 +138,34 @@ boost::json::object qmp_execute_json(const QString& cmd)
     return {{"execute", cmd.toStdString()}};
 }
 
+boost::json::object image_snapshot_json(const QString& cmd, const std::string& tag)
+{
+    auto qmp = qmp_execute_json(cmd);
+    qmp["arguments"] = {{"device", mp::QemuVMProcessSpec::drive_id}, {"name", tag}};
+    return qmp;
+}
+
+// Picks the snapshot tags of the instance's image out of a query-block reply
+std::unordered_set<std::string> image_snapshot_tags(const boost::json::value& block_info)
+{
+    std::unordered_set<std::string> tags;
+    for (const auto& device : block_info.as_array())
+    {
+        if (value_to<std::string>(device.at("device")) != mp::QemuVMProcessSpec::drive_id)
+            continue;
+
+        const auto* inserted = device.as_object().if_contains("inserted");
+        const auto* image = inserted ? inserted->as_object().if_contains("image") : nullptr;
+        if (const auto* snapshots = image ? image->as_object().if_contains("snapshots") : nullptr)
+        {
+            for (const auto& snapshot : snapshots->as_array())
+                tags.insert(value_to<std::string>(snapshot.at("name")));
+        }
+    }
+
+    return tags;
+}
+
 boost::json::object hmc_to_qmp_json(const QString& command_line)
 {
     auto qmp = qmp_execute_json("human-monitor-command");
@@ -136,6 +173,38 @@ boost::json::object hmc_to_qmp_json(const QString& command_line)
     return qmp;
 }
 
+// The capabilities both ends of a suspension need to agree on. With mapped-ram, each page of RAM
+// has a fixed place in the state file, so zero pages are never written and multifd channels can
+// write in parallel. Events let us know when the migration is over.
+boost::json::object suspend_capabilities_json()
+{
+    boost::json::array capabilities;
+    for (const auto* capability : {"events", "mapped-ram", "multifd"})
+        capabilities.push_back(boost::json::object{{"capability", capability}, {"state", true}});
+
+    auto qmp = qmp_execute_json("migrate-set-capabilities");
+    qmp["arguments"] = boost::json::object{{"capabilities", std::move(capabilities)}};
+    return qmp;
+}
+
+std::string suspend_state_uri(const mp::VirtualMachineDescription& desc)
+{
+    return "file:" + mp::QemuVMProcessSpec::suspend_state_path(desc).string();
+}
+
+bool has_suspension_state(const mp::VirtualMachineDescription& desc)
+{
+    return MP_FILEOPS.exists(mp::QemuVMProcessSpec::suspend_state_path(desc)) ||
+           mp::backend::instance_image_has_snapshot(desc.image.image_path, suspend_tag);
+}
+
+void remove_suspension_state_file(const mp::VirtualMachineDescription& desc)
+{
+    std::error_code err;
+    if (MP_FILEOPS.remove(mp::QemuVMProcessSpec::suspend_state_path(desc), err); err)
+        mpl::warn(desc.vm_name, "Could not remove the suspension state file: {}", err.message());
+}
+
 std::string get_qemu_machine_type(const QStringList& platform_args)
 {
     QTemporaryFile dump_file;
@@ -225,10 +294,7 @@ mp::QemuVirtualMachine::QemuVirtualMachine(const VirtualMachineDescription& desc
                                            AvailabilityZone& zone,
                                            const Path& instance_dir,
                                            bool remove_snapshots)
-    : BaseVirtualMachine{mp::backend::instance_image_has_snapshot(desc.image.image_path,
-                                                                  suspend_tag)
-                             ? State::suspended
-                             : State::off,
+    : BaseVirtualMachine{has_suspension_state(desc) ? State::suspended : State::off,
                          desc.vm_name,
                          desc,
                          key_provider,
@@ -268,6 +334,7 @@ mp::QemuVirtualMachine::~QemuVirtualMachine()
 
 void mp::QemuVirtualMachine::start()
 {
+    forget_image_snapshots();
     initialize_vm_process();
 
     if (state == State::suspended)
@@ -281,17 +348,18 @@ void mp::QemuVirtualMachine::start()
     else
     {
         // remove the mount arguments from the rest of the arguments, as they are stored separately
-        // for easier retrieval
+        // for easier retrieval. They always come last, and may repeat options used elsewhere (e.g.
+        // -chardev), so they are dropped by position rather than by value
         auto proc_args = vm_process->arguments();
         for (const auto& [_, mount_data] : mount_args)
-            for (const auto& arg : mount_data.second)
-                proc_args.removeOne(arg);
+            proc_args.resize(proc_args.size() - mount_data.second.size());
 
         monitor->update_metadata_for(
             vm_name,
             generate_metadata(qemu_platform->vmstate_platform_args(), proc_args, mount_args));
     }
 
+    start_virtiofsd_processes();
     vm_process->start();
     connect_vm_signals();
 
@@ -317,6 +385,16 @@ void mp::QemuVirtualMachine::start()
     }
 
     vm_process->write(QByteArray::fromStdString(serialize(qmp_execute_json("qmp_capabilities"))));
+
+    if (is_resuming_from_state_file)
+    {
+        auto qmp = qmp_execute_json("migrate-incoming");
+        qmp["arguments"] = {{"uri", suspend_state_uri(desc)}};
+        qmp["id"] = resume_migrate_id;
+
+        vm_process->write(QByteArray::fromStdString(serialize(suspend_capabilities_json())));
+        vm_process->write(QByteArray::fromStdString(serialize(qmp)));
+    }
 }
 
 void mp::QemuVirtualMachine::shutdown(ShutdownPolicy shutdown_policy)
@@ -356,17 +434,26 @@ void mp::QemuVirtualMachine::shutdown(ShutdownPolicy shutdown_policy)
             mpl::debug(vm_name, "No process to kill");
         }
 
+        const auto has_suspend_file =
+            MP_FILEOPS.exists(QemuVMProcessSpec::suspend_state_path(desc));
         const auto has_suspend_snapshot =
+            has_suspend_file ||
             mp::backend::instance_image_has_snapshot(desc.image.image_path, suspend_tag);
         if (has_suspend_snapshot != (state == State::suspended)) // clang-format off
             mpl::warn(vm_name, "Image has {} suspension snapshot, but the state is {}",
                                                                has_suspend_snapshot ? "a" : "no",
                                                                static_cast<short>(state)); // clang-format on
 
-        if (has_suspend_snapshot)
+        if (has_suspend_file)
+        {
+            mpl::info(vm_name, "Deleting suspend state");
+            remove_suspension_state_file(desc);
+        }
+        else if (has_suspend_snapshot)
         {
             mpl::info(vm_name, "Deleting suspend image");
             mp::backend::delete_snapshot_from_image(desc.image.image_path, suspend_tag);
+            record_image_snapshot(suspend_tag, false);
         }
 
         state = State::off;
@@ -408,11 +495,66 @@ void mp::QemuVirtualMachine::suspend()
         }
 
         drop_ssh_session();
-        vm_process->write(QByteArray::fromStdString(
-            serialize(hmc_to_qmp_json(QString{"savevm "} + suspend_tag))));
-        vm_process->wait_for_finished(vm_shutdown_timeout);
 
+        // Try to migrate the state out to a file first, falling back to saving it into the image
+        // if QEMU cannot do that. Either way, QMP replies and events drive the rest while we wait.
+        suspension = Suspension::negotiating;
+        auto qmp = suspend_capabilities_json();
+        qmp["id"] = suspend_capabilities_id;
+        vm_process->write(QByteArray::fromStdString(serialize(qmp)));
+
+        constexpr auto wait_slice = 100ms;
+        for (auto waited = 0ms; waited < vm_shutdown_timeout; waited += wait_slice)
+        {
+            if (suspension == Suspension::none || suspension == Suspension::failed ||
+                !vm_process->running() || vm_process->wait_for_finished(wait_slice))
+                break;
+        }
+
+        const auto unfinished =
+            suspension == Suspension::negotiating || suspension == Suspension::migrating;
+        const auto timed_out = unfinished && vm_process->running();
+        const auto exited = unfinished && !timed_out;
+        if (timed_out)
+        {
+            // Stop QEMU writing the state, it carries on running the instance once cancelled
+            mpl::warn(vm_name, "Suspending did not finish in time, cancelling it");
+            vm_process->write(
+                QByteArray::fromStdString(serialize(qmp_execute_json("migrate_cancel"))));
+        }
+
+        // A partial state file must not be mistaken for a suspended instance
+        if (unfinished || suspension == Suspension::failed)
+            remove_suspension_state_file(desc);
+
+        if (exited)
+        {
+            // QEMU went away with the instance's state only partly written out, so it is lost
+            suspension = Suspension::none;
+            update_shutdown_status = true;
+            on_shutdown();
+            throw std::runtime_error{
+                fmt::format("Failed to suspend {}, the instance stopped before its state was saved",
+                            vm_name)};
+        }
+
+        if (timed_out || suspension == Suspension::failed)
+        {
+            suspension = timed_out ? Suspension::cancelling : Suspension::none;
+
+            // QEMU carries on running the instance when a migration fails
+            state = State::running;
+            handle_state_update();
+            update_shutdown_status = true;
+            throw std::runtime_error{
+                fmt::format("Failed to suspend {}{}, the instance was left running",
+                            vm_name,
+                            timed_out ? " in time" : "")};
+        }
+
+        suspension = Suspension::none;
         vm_process.reset(nullptr);
+        virtiofsd_processes.clear();
     }
     else if (state == State::off || state == State::suspended || state == State::unavailable)
     {
@@ -464,6 +606,7 @@ void mp::QemuVirtualMachine::on_shutdown()
         drop_ssh_session();
         handle_state_update();
         vm_process.reset(nullptr);
+        virtiofsd_processes.clear();
     }
 
     monitor->on_shutdown();
@@ -476,6 +619,19 @@ void mp::QemuVirtualMachine::on_suspend()
     monitor->on_suspend();
 }
 
+void mp::QemuVirtualMachine::on_resume_failure(const std::string& reason)
+{
+    // QEMU would wait for the incoming state forever, and the state is no good to retry with
+    mpl::error(vm_name, "Failed to resume from the suspended state: {}", reason);
+    save_error_msg(fmt::format("could not resume from the suspended state ({}), discarded it",
+                               reason));
+
+    is_resuming_from_state_file = false;
+    is_starting_from_suspend = false;
+    remove_suspension_state_file(desc);
+    vm_process->kill();
+}
+
 void mp::QemuVirtualMachine::on_restart()
 {
     drop_ssh_session();
@@ -518,6 +674,9 @@ void mp::QemuVirtualMachine::wait_until_ssh_up(std::chrono::milliseconds timeout
 
 void mp::QemuVirtualMachine::initialize_vm_process()
 {
+    is_resuming_from_state_file =
+        state == State::suspended && MP_FILEOPS.exists(QemuVMProcessSpec::suspend_state_path(desc));
+    qmp_output_buffer.clear();
     vm_process = make_qemu_process(
         desc,
         ((state == State::suspended) ? std::make_optional(monitor->retrieve_metadata_for(vm_name))
@@ -533,48 +692,34 @@ void mp::QemuVirtualMachine::initialize_vm_process()
     QObject::connect(vm_process.get(), &Process::ready_read_standard_output, [this]() {
         auto qmp_output = vm_process->read_all_standard_output();
         mpl::debug(vm_name, "QMP: {}", qmp_output);
-        // Skip non-JSON output.
-        const auto lines = qmp_output.split('\n');
-        const auto json_line = std::find_if(lines.cbegin(), lines.cend(), [](const QString& line) {
-            return line.startsWith('{');
-        });
-        if (json_line == lines.cend())
+
+        // Messages end in a newline, but several may arrive together (e.g. a reply and an event)
+        // and large ones may arrive split across reads. Keep any unfinished line for the next read.
+        qmp_output_buffer.append(qmp_output);
+        const auto end = qmp_output_buffer.lastIndexOf('\n');
+        if (end == -1)
             return;
-        auto qmp_object = boost::json::parse(json_line->toStdString()).as_object();
 
-        if (auto event = qmp_object.if_contains("event"))
+        const auto lines = qmp_output_buffer.first(end).split('\n');
+        qmp_output_buffer.remove(0, end + 1);
+
+        for (const auto& line : lines)
         {
-            auto event_str = value_to<std::string>(*event);
-            if (event_str == "RESET" && state != State::restarting)
-            {
-                mpl::info(vm_name, "VM restarting");
-                on_restart();
-            }
-            else if (event_str == "POWERDOWN")
-            {
-                mpl::info(vm_name, "VM powering down");
-            }
-            else if (event_str == "SHUTDOWN")
-            {
-                mpl::info(vm_name, "VM shut down");
-            }
-            else if (event_str == "STOP")
+            if (!line.startsWith('{')) // skip non-JSON output
+                continue;
+
+            boost::json::object qmp_object;
+            try
             {
-                mpl::info(vm_name, "VM suspending");
+                qmp_object = boost::json::parse(line.toStdString()).as_object();
             }
-            else if (event_str == "RESUME")
+            catch (const std::exception& e)
             {
-                mpl::info(vm_name, "VM suspended");
-                if (state == State::suspending || state == State::running)
-                {
-                    vm_process->kill();
-                    on_suspend();
-                }
+                mpl::warn(vm_name, "Ignoring unreadable QMP message: {}", e.what());
+                continue;
             }
-        }
-        else if (auto error = qmp_object.if_contains("error"))
-        {
-            mpl::error(vm_name, "QMP error: {}", value_to<std::string>(error->at("desc")));
+
+            handle_qmp_message(qmp_object);
         }
     });
 
@@ -622,7 +767,7 @@ void mp::QemuVirtualMachine::initialize_vm_process()
             if (process_state.error->state == QProcess::Crashed &&
                 (state == State::suspending || state == State::suspended))
             {
-                // when suspending, we ask Qemu to savevm. Once it confirms that's done, we kill it.
+                // when suspending, we ask Qemu to save the VM state. Once that is done, we kill it.
                 // Catch the "crash"
                 mpl::debug(vm_name, "Suspended VM successfully stopped");
             }
@@ -643,6 +788,182 @@ void mp::QemuVirtualMachine::initialize_vm_process()
     });
 }
 
+void mp::QemuVirtualMachine::start_virtiofsd_processes()
+{
+    virtiofsd_processes.clear();
+
+    for (const auto& [tag, share] : virtiofs_shares)
+    {
+        // QEMU connects to the socket as soon as it starts, so virtiofsd must be listening by then
+        const std::filesystem::path socket_path = share.socket_path().toStdString();
+        std::error_code err;
+        if (MP_FILEOPS.create_directories(socket_path.parent_path(), err); err)
+            throw std::runtime_error{fmt::format("Failed to create directory for {}: {}",
+                                                 socket_path.string(),
+                                                 err.message())};
+        MP_FILEOPS.remove(socket_path, err); // left over from an unclean stop
+
+        auto process = mp::platform::make_process(std::make_unique<VirtiofsdProcessSpec>(share));
+        process->start();
+        if (!process->wait_for_started())
+            throw std::runtime_error{fmt::format("Failed to start virtiofsd for mount tag {}: {}",
+                                                 tag,
+                                                 process->process_state().failure_message())};
+
+        auto on_timeout = [&tag] {
+            throw std::runtime_error{
+                fmt::format("Timed out waiting for virtiofsd to listen for mount tag {}", tag)};
+        };
+        mp::utils::try_action_for(on_timeout, 5s, [&socket_path] {
+            return MP_FILEOPS.exists(socket_path) ? mp::utils::TimeoutAction::done
+                                                  : mp::utils::TimeoutAction::retry;
+        });
+
+        mpl::debug(vm_name, "virtiofsd serving mount tag {}", tag);
+        virtiofsd_processes.push_back(std::move(process));
+    }
+}
+
+void mp::QemuVirtualMachine::handle_qmp_message(const boost::json::object& qmp_object)
+{
+    const auto id = qmp_object.contains("id") ? value_to<std::string>(qmp_object.at("id"))
+                                              : std::string{};
+    if (!id.empty() && id == awaited_qmp_id)
+    {
+        awaited_qmp_reply = qmp_object;
+        return;
+    }
+
+    if (auto event = qmp_object.if_contains("event"))
+    {
+        auto event_str = value_to<std::string>(*event);
+        if (event_str == "RESET" && state != State::restarting)
+        {
+            mpl::info(vm_name, "VM restarting");
+            on_restart();
+        }
+        else if (event_str == "POWERDOWN")
+        {
+            mpl::info(vm_name, "VM powering down");
+        }
+        else if (event_str == "SHUTDOWN")
+        {
+            mpl::info(vm_name, "VM shut down");
+        }
+        else if (event_str == "STOP")
+        {
+            mpl::info(vm_name, "VM suspending");
+        }
+        else if (event_str == "RESUME")
+        {
+            // QEMU resumes the VM once savevm is done with it
+            if (suspension == Suspension::saving)
+            {
+                mpl::info(vm_name, "VM suspended");
+                suspension = Suspension::none;
+                vm_process->kill();
+                on_suspend();
+            }
+        }
+        else if (event_str == "MIGRATION")
+        {
+            const auto status = value_to<std::string>(qmp_object.at("data").at("status"));
+            mpl::debug(vm_name, "Migration status: {}", status);
+
+            if (status == "completed" && suspension == Suspension::migrating)
+            {
+                mpl::info(vm_name, "VM suspended");
+                suspension = Suspension::none;
+                vm_process->kill();
+                on_suspend();
+            }
+            else if (status == "completed" && suspension == Suspension::cancelling)
+            {
+                // The migration finished before the cancellation got to it, leaving the VM paused
+                suspension = Suspension::none;
+                vm_process->write(QByteArray::fromStdString(serialize(qmp_execute_json("cont"))));
+            }
+            else if (status == "failed" || status == "cancelled")
+            {
+                mpl::error(vm_name, "Migration {}", status);
+                if (suspension == Suspension::migrating)
+                    suspension = Suspension::failed;
+                else if (suspension == Suspension::cancelling)
+                    suspension = Suspension::none;
+                else if (is_resuming_from_state_file)
+                    on_resume_failure("loading the state file failed");
+            }
+        }
+    }
+    else if (qmp_object.contains("return"))
+    {
+        if (id == suspend_capabilities_id && suspension == Suspension::negotiating)
+        {
+            mpl::debug(vm_name, "Migrating VM state to file");
+            suspension = Suspension::migrating;
+
+            auto qmp = qmp_execute_json("migrate");
+            qmp["arguments"] = {{"uri", suspend_state_uri(desc)}};
+            qmp["id"] = suspend_migrate_id;
+            vm_process->write(QByteArray::fromStdString(serialize(qmp)));
+        }
+    }
+    else if (auto error = qmp_object.if_contains("error"))
+    {
+        const auto error_desc = value_to<std::string>(error->at("desc"));
+        if (id == suspend_capabilities_id && suspension == Suspension::negotiating)
+        {
+            mpl::info(vm_name,
+                      "Cannot migrate VM state to file ({}), saving it to the image instead",
+                      error_desc);
+            suspension = Suspension::saving;
+            vm_process->write(QByteArray::fromStdString(
+                serialize(hmc_to_qmp_json(QString{"savevm "} + suspend_tag))));
+        }
+        else
+        {
+            mpl::error(vm_name, "QMP error: {}", error_desc);
+            if (id == suspend_migrate_id && suspension == Suspension::migrating)
+                suspension = Suspension::failed;
+            else if (id == resume_migrate_id && is_resuming_from_state_file)
+                on_resume_failure(error_desc);
+        }
+    }
+}
+
+boost::json::value mp::QemuVirtualMachine::execute_qmp(boost::json::object qmp)
+{
+    const auto command = value_to<std::string>(qmp.at("execute"));
+    if (!vm_process || !vm_process->running())
+        throw std::runtime_error{fmt::format("Cannot run {}, QEMU is not running", command)};
+
+    awaited_qmp_id = fmt::format("{}-{}", command, ++qmp_request_count);
+    awaited_qmp_reply.reset();
+    auto stop_awaiting = sg::make_scope_guard([this]() noexcept { awaited_qmp_id.clear(); });
+
+    qmp["id"] = awaited_qmp_id;
+    vm_process->write(QByteArray::fromStdString(serialize(qmp)));
+
+    // The reply is handled as it is read, including while waiting here
+    constexpr auto wait_slice = 100ms;
+    for (auto waited = 0ms; !awaited_qmp_reply && waited < qmp_reply_timeout; waited += wait_slice)
+    {
+        if (!vm_process || !vm_process->running())
+            break;
+        vm_process->wait_for_ready_read(wait_slice);
+    }
+
+    if (!awaited_qmp_reply)
+        throw std::runtime_error{fmt::format("QEMU did not reply to {}", command)};
+
+    if (auto error = awaited_qmp_reply->if_contains("error"))
+        throw std::runtime_error{fmt::format("QMP command {} failed: {}",
+                                             command,
+                                             value_to<std::string>(error->at("desc")))};
+
+    return awaited_qmp_reply->at("return");
+}
+
 void mp::QemuVirtualMachine::connect_vm_signals()
 {
     std::unique_lock lock{vm_signal_mutex};
@@ -656,9 +977,13 @@ void mp::QemuVirtualMachine::connect_vm_signals()
         this,
         [this] {
             mpl::debug(vm_name, "Deleted memory snapshot");
-            vm_process->write(QByteArray::fromStdString(
-                serialize(hmc_to_qmp_json(QString("delvm ") + suspend_tag))));
+            if (is_resuming_from_state_file)
+                remove_suspension_state_file(desc);
+            else
+                vm_process->write(QByteArray::fromStdString(
+                    serialize(hmc_to_qmp_json(QString("delvm ") + suspend_tag))));
             is_starting_from_suspend = false;
+            is_resuming_from_state_file = false;
         },
         Qt::QueuedConnection);
 
@@ -744,7 +1069,7 @@ mp::MountHandler::UPtr mp::QemuVirtualMachine::make_native_mount_handler(const s
     return std::make_unique<QemuMountHandler>(this, &key_provider, target, mount);
 }
 
-void mp::QemuVirtualMachine::remove_snapshots_from_backend() const
+void mp::QemuVirtualMachine::remove_snapshots_from_backend()
 {
     const QStringList snapshot_tag_list =
         extract_snapshot_tags(backend::snapshot_list_output(desc.image.image_path));
@@ -753,6 +1078,70 @@ void mp::QemuVirtualMachine::remove_snapshots_from_backend() const
     {
         backend::delete_snapshot_from_image(desc.image.image_path, snapshot_tag);
     }
+
+    std::lock_guard lock{image_snapshots_mutex};
+    image_snapshots.emplace();
+}
+
+bool mp::QemuVirtualMachine::supports_live_snapshots() const
+{
+    return true;
+}
+
+bool mp::QemuVirtualMachine::image_has_snapshot(const std::string& tag)
+{
+    std::lock_guard lock{image_snapshots_mutex};
+    if (!image_snapshots)
+    {
+        if (image_in_use())
+        {
+            image_snapshots = image_snapshot_tags(execute_qmp(qmp_execute_json("query-block")));
+        }
+        else
+        {
+            const auto listed_tags =
+                extract_snapshot_tags(backend::snapshot_list_output(desc.image.image_path));
+
+            image_snapshots.emplace();
+            for (const auto& listed_tag : listed_tags)
+                image_snapshots->insert(listed_tag.toStdString());
+        }
+    }
+
+    return image_snapshots->contains(tag);
+}
+
+void mp::QemuVirtualMachine::record_image_snapshot(const std::string& tag, bool present)
+{
+    std::lock_guard lock{image_snapshots_mutex};
+    if (!image_snapshots)
+        return; // nothing to keep up to date, tags will be listed when next needed
+
+    if (present)
+        image_snapshots->insert(tag);
+    else
+        image_snapshots->erase(tag);
+}
+
+bool mp::QemuVirtualMachine::image_in_use() const
+{
+    return vm_process && vm_process->running();
+}
+
+void mp::QemuVirtualMachine::take_live_image_snapshot(const std::string& tag)
+{
+    execute_qmp(image_snapshot_json("blockdev-snapshot-internal-sync", tag));
+}
+
+void mp::QemuVirtualMachine::delete_live_image_snapshot(const std::string& tag)
+{
+    execute_qmp(image_snapshot_json("blockdev-snapshot-delete-internal-sync", tag));
+}
+
+void mp::QemuVirtualMachine::forget_image_snapshots()
+{
+    std::lock_guard lock{image_snapshots_mutex};
+    image_snapshots.reset();
 }
 
 mp::QemuVirtualMachine::MountArgs& mp::QemuVirtualMachine::modifiable_mount_args()
@@ -760,6 +1149,11 @@ mp::QemuVirtualMachine::MountArgs& mp::QemuVirtualMachine::modifiable_mount_args
     return mount_args;
 }
 
+mp::QemuVirtualMachine::VirtiofsShares& mp::QemuVirtualMachine::modifiable_virtiofs_shares()
+{
+    return virtiofs_shares;
+}
+
 auto mp::QemuVirtualMachine::make_specific_snapshot(const std::string& snapshot_name,
                                                     const std::string& comment,
                                                     const std::string& instance_id,
@@ -767,13 +1161,16 @@ auto mp::QemuVirtualMachine::make_specific_snapshot(const std::string& snapshot_
                                                     std::shared_ptr<Snapshot> parent)
     -> std::shared_ptr<Snapshot>
 {
-    assert(state == VirtualMachine::State::off ||
-           state == VirtualMachine::State::stopped); // would need QMP otherwise
+    // Snapshots of running instances hold the disk alone, so they restore to a stopped instance
+    auto snapshot_specs = specs;
+    if (state != VirtualMachine::State::off && state != VirtualMachine::State::stopped)
+        snapshot_specs.state = VirtualMachine::State::off;
+
     return std::make_shared<QemuSnapshot>(snapshot_name,
                                           comment,
                                           instance_id,
                                           std::move(parent),
-                                          specs,
+                                          snapshot_specs,
                                           *this,
                                           desc);
 }
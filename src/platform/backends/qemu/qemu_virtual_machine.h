@@ -18,6 +18,7 @@
 #pragma once
 
 #include "qemu_platform.h"
+#include "virtiofsd_process_spec.h"
 
 #include <shared/base_virtual_machine.h>
 
@@ -25,11 +26,20 @@
 #include <multipass/process/process.h>
 #include <multipass/virtual_machine_description.h>
 
+#include <QByteArray>
 #include <QObject>
 #include <QStringList>
 
+#include <boost/json.hpp>
+
 #include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace multipass
 {
@@ -41,6 +51,7 @@ class QemuVirtualMachine : public QObject, public BaseVirtualMachine
     Q_OBJECT
 public:
     using MountArgs = std::unordered_map<std::string, std::pair<std::string, QStringList>>;
+    using VirtiofsShares = std::unordered_map<std::string, VirtiofsdProcessSpec>; // by mount tag
 
     QemuVirtualMachine(const VirtualMachineDescription& desc,
                        QemuPlatform* qemu_platform,
@@ -67,8 +78,22 @@ public:
                                        const std::string& default_mac_addr,
                                        const NetworkInterface& extra_interface) override;
     virtual MountArgs& modifiable_mount_args();
+    VirtiofsShares& modifiable_virtiofs_shares();
     std::unique_ptr<MountHandler> make_native_mount_handler(const std::string& target,
                                                             const VMMount& mount) override;
+
+    bool supports_live_snapshots() const override;
+
+    // The snapshot tags in the image are listed once and then tracked in memory. QEMU itself may
+    // change them while running, so they are listed anew after every start.
+    bool image_has_snapshot(const std::string& tag);
+    void record_image_snapshot(const std::string& tag, bool present);
+
+    // While QEMU runs, it holds the image, so snapshots in it are taken and deleted over QMP
+    // instead of with qemu-img. Those snapshots hold the disk alone, not the instance's memory.
+    bool image_in_use() const;
+    void take_live_image_snapshot(const std::string& tag);
+    void delete_live_image_snapshot(const std::string& tag);
 signals:
     void on_delete_memory_snapshot();
     void on_reset_network();
@@ -100,22 +125,48 @@ private:
     void on_error();
     void on_shutdown();
     void on_suspend();
+    void on_resume_failure(const std::string& reason);
     void on_restart();
     void initialize_vm_process();
+    void start_virtiofsd_processes();
+    void handle_qmp_message(const boost::json::object& qmp_object);
+    boost::json::value execute_qmp(boost::json::object qmp); // waits for the reply
 
     void connect_vm_signals();
     void disconnect_vm_signals();
-    void remove_snapshots_from_backend() const;
+    void remove_snapshots_from_backend();
+    void forget_image_snapshots();
 
     std::unique_ptr<Process> vm_process{nullptr};
     QemuPlatform* qemu_platform;
     VMStatusMonitor* monitor;
     MountArgs mount_args;
+    VirtiofsShares virtiofs_shares;
+    std::vector<std::unique_ptr<Process>> virtiofsd_processes;
     bool update_shutdown_status{true};
     bool is_starting_from_suspend{false};
+    bool is_resuming_from_state_file{false};
     bool force_shutdown{false};
     std::mutex vm_signal_mutex;
     bool vm_signals_connected{false};
     std::chrono::steady_clock::time_point network_deadline;
+    std::mutex image_snapshots_mutex;
+    std::optional<std::unordered_set<std::string>> image_snapshots;
+    QByteArray qmp_output_buffer; // holds an unfinished line of QMP output
+    int qmp_request_count{0};
+    std::string awaited_qmp_id;
+    std::optional<boost::json::object> awaited_qmp_reply;
+
+    // How far along suspend() is in saving the instance's state
+    enum class Suspension
+    {
+        none,
+        negotiating,
+        migrating,
+        saving,
+        failed,
+        cancelling // after giving up on it
+    };
+    Suspension suspension{Suspension::none};
 };
 } // namespace multipass
@@ -27,10 +27,33 @@
 #include <QCoreApplication>
 #include <QRegularExpression>
 
+#include <algorithm>
+
 namespace mp = multipass;
 namespace mpl = multipass::logging;
 namespace mpu = multipass::utils;
 
+namespace
+{
+// virtio-fs mounts reach QEMU through virtiofsd's vhost-user socket, rather than a host directory
+QString virtiofs_socket_in(const QStringList& mount_args)
+{
+    static const QRegularExpression socket_regex{"^socket,.*path=([^,]+)"};
+    for (const auto& arg : mount_args)
+        if (const auto match = socket_regex.match(arg); match.hasMatch())
+            return match.captured(1);
+
+    return {};
+}
+
+bool has_virtiofs_mounts(const mp::QemuVirtualMachine::MountArgs& mount_args)
+{
+    return std::any_of(mount_args.cbegin(), mount_args.cend(), [](const auto& mount) {
+        return !virtiofs_socket_in(mount.second.second).isEmpty();
+    });
+}
+} // namespace
+
 mp::QemuVMProcessSpec::QemuVMProcessSpec(const mp::VirtualMachineDescription& desc,
                                          const QStringList& platform_args,
                                          const mp::QemuVirtualMachine::MountArgs& mount_args,
@@ -55,7 +78,10 @@ QStringList mp::QemuVMProcessSpec::arguments() const
         }
 
         // need to append extra arguments for resume
-        args << "-loadvm" << resume_data->suspend_tag;
+        if (resume_data->from_state_file)
+            args << "-incoming" << "defer"; // the state file is fed in over QMP
+        else
+            args << "-loadvm" << resume_data->suspend_tag;
 
         QString machine_type = resume_data->machine_type;
         if (!machine_type.isEmpty())
@@ -94,14 +120,20 @@ in `man qemu-system`, under `-m` option; including suffix to avoid relying on de
              << "virtio-scsi-pci,id=scsi0"
 #endif
              << "-drive"
-             << QString("file=%1,if=none,format=qcow2,discard=unmap,id=hda")
-                    .arg(MP_PLATFORM.path_to_qstr(desc.image.image_path))
+             << QString("file=%1,if=none,format=qcow2,discard=unmap,id=%2")
+                    .arg(MP_PLATFORM.path_to_qstr(desc.image.image_path), QLatin1String{drive_id})
              << "-device"
-             << "scsi-hd,drive=hda,bus=scsi0.0";
+             << QString("scsi-hd,drive=%1,bus=scsi0.0").arg(QLatin1String{drive_id});
         // Number of cpu cores
         args << "-smp" << QString::number(desc.num_cores);
         // Memory to use for VM
         args << "-m" << mem_size;
+        // virtiofsd needs to map guest memory, so it must be shareable
+        if (has_virtiofs_mounts(mount_args))
+            args << "-object"
+                 << QString{"memory-backend-memfd,id=mem,size=%1,share=on"}.arg(mem_size)
+                 << "-numa"
+                 << "node,memdev=mem";
         // Control interface
         args << "-qmp"
              << "stdio";
@@ -211,9 +243,10 @@ profile %1 flags=(attach_disconnected) {
   # Disk images
   %6 rwk,  # QCow2 filesystem image
   %7 rk,   # cloud-init ISO
+  %8 rw,   # suspended VM state
 
   # allow full access just to user-specified mount directories on the host
-  %8
+  %9
 }
     )END");
 
@@ -225,7 +258,13 @@ profile %1 flags=(attach_disconnected) {
 
     for (const auto& [_, mount_data] : mount_args)
     {
-        const auto& [source_path, __] = mount_data;
+        const auto& [source_path, args] = mount_data;
+        if (const auto socket = virtiofs_socket_in(args); !socket.isEmpty())
+        {
+            mount_dirs += socket + " rw,\n  "; // virtiofsd is the one accessing the directory
+            continue;
+        }
+
         mount_dirs += QString::fromStdString(source_path) + "/ rw,\n  ";
         mount_dirs += QString::fromStdString(source_path) + "/** rwlk,\n  ";
     }
@@ -249,9 +288,16 @@ profile %1 flags=(attach_disconnected) {
                                 program(),
                                 QString::fromStdString(desc.image.image_path),
                                 desc.cloud_init_iso,
+                                MP_PLATFORM.path_to_qstr(suspend_state_path(desc)),
                                 mount_dirs);
 }
 
+std::filesystem::path mp::QemuVMProcessSpec::suspend_state_path(
+    const VirtualMachineDescription& desc)
+{
+    return desc.image.image_path.parent_path() / "suspend.vmstate";
+}
+
 QString mp::QemuVMProcessSpec::identifier() const
 {
     return QString::fromStdString(desc.vm_name);
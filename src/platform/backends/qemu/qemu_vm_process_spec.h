@@ -22,6 +22,7 @@
 
 #include <multipass/virtual_machine_description.h>
 
+#include <filesystem>
 #include <optional>
 
 namespace multipass
@@ -35,10 +36,17 @@ public:
         QString suspend_tag;
         QString machine_type;
         QStringList arguments;
+        bool from_state_file{false};
     };
 
     static QString default_machine_type();
 
+    // The id of the instance's image drive, which names it in QMP commands
+    static constexpr auto drive_id = "hda";
+
+    // Where the state of a suspended VM goes when it is migrated out rather than saved in the image
+    static std::filesystem::path suspend_state_path(const VirtualMachineDescription& desc);
+
     explicit QemuVMProcessSpec(const VirtualMachineDescription& desc,
                                const QStringList& platform_args,
                                const QemuVirtualMachine::MountArgs& mount_args,
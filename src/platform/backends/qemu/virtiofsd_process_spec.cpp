@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "virtiofsd_process_spec.h"
+
+#include <multipass/exceptions/snap_environment_exception.h>
+#include <multipass/snap_utils.h>
+
+namespace mp = multipass;
+namespace mpu = multipass::utils;
+
+namespace
+{
+QString root_dir() // either "" or $SNAP
+{
+    try
+    {
+        return mpu::snap_dir();
+    }
+    catch (const mp::SnapEnvironmentException&)
+    {
+        return {};
+    }
+}
+} // namespace
+
+mp::VirtiofsdProcessSpec::VirtiofsdProcessSpec(const QString& tag,
+                                               const QString& shared_dir,
+                                               const QString& vhost_socket,
+                                               const QString& cache_policy,
+                                               const IdMap& uid_map,
+                                               const IdMap& gid_map)
+    : tag{tag},
+      shared_dir{shared_dir},
+      vhost_socket{vhost_socket},
+      cache_policy{cache_policy},
+      uid_map{uid_map},
+      gid_map{gid_map}
+{
+}
+
+QString mp::VirtiofsdProcessSpec::program() const
+{
+    return virtiofsd_path();
+}
+
+QStringList mp::VirtiofsdProcessSpec::arguments() const
+{
+    QStringList args{QString{"--socket-path=%1"}.arg(vhost_socket),
+                     QString{"--shared-dir=%1"}.arg(shared_dir),
+                     QString{"--cache=%1"}.arg(cache_policy)};
+
+    // IDs pass through untranslated by default, so only ask for the translation when needed
+    // (which takes virtiofsd 1.11 or newer)
+    const auto translation = [](const char* option, const IdMap& map) {
+        return QString{"--%1=map:%2:%3:1"}.arg(option).arg(map.second).arg(map.first);
+    };
+    if (uid_map.first != uid_map.second)
+        args << translation("translate-uid", uid_map);
+    if (gid_map.first != gid_map.second)
+        args << translation("translate-gid", gid_map);
+
+    return args;
+}
+
+QString mp::VirtiofsdProcessSpec::apparmor_profile() const
+{
+    QString profile_template(R"END(
+#include <tunables/global>
+profile %1 flags=(attach_disconnected) {
+  #include <abstractions/base>
+
+  # for the sandbox virtiofsd sets up around the shared directory
+  capability chown,
+  capability dac_override,
+  capability dac_read_search,
+  capability fowner,
+  capability fsetid,
+  capability mknod,
+  capability setgid,
+  capability setuid,
+  capability sys_admin,
+  capability sys_chroot,
+  capability sys_resource,
+  mount,
+  umount,
+  pivot_root,
+  @{PROC}/** r,
+
+  # Allow multipassd send virtiofsd signals
+  signal (receive) peer=%2,
+
+  # binary and its libs
+  %3 ixr,
+  %4/{,usr/}lib/{,@{multiarch}/}{,**/}*.so* rm,
+
+  %5 rw,    # vhost-user socket
+
+  # allow full access just to the shared directory
+  %6/ rw,
+  %6/** rwlk,
+}
+    )END");
+
+    const auto root = root_dir();
+    const QString signal_peer = root.isEmpty() ? "unconfined" : "snap.multipass.multipassd";
+
+    return profile_template
+        .arg(apparmor_profile_name(), signal_peer, program(), root, vhost_socket, shared_dir);
+}
+
+QString mp::VirtiofsdProcessSpec::identifier() const
+{
+    return tag;
+}
+
+QString mp::VirtiofsdProcessSpec::virtiofsd_path()
+{
+    return root_dir() + "/usr/libexec/virtiofsd"; // where distributions install it, off $PATH
+}
+
+QString mp::VirtiofsdProcessSpec::socket_dir()
+{
+    // the snap can only write to its own directory under /run
+    return mpu::in_multipass_snap() ? QStringLiteral("/run/snap.multipass/virtiofs")
+                                    : QStringLiteral("/run/multipass/virtiofs");
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <multipass/process/process_spec.h>
+
+#include <QString>
+#include <QStringList>
+
+#include <utility>
+
+namespace multipass
+{
+
+// Serves a host directory to a QEMU instance over a vhost-user socket, for virtio-fs mounts
+class VirtiofsdProcessSpec : public ProcessSpec
+{
+public:
+    using IdMap = std::pair<int, int>; // host id, instance id
+
+    VirtiofsdProcessSpec(const QString& tag,
+                         const QString& shared_dir,
+                         const QString& vhost_socket,
+                         const QString& cache_policy,
+                         const IdMap& uid_map,
+                         const IdMap& gid_map);
+
+    QString program() const override;
+    QStringList arguments() const override;
+    QString apparmor_profile() const override;
+    QString identifier() const override;
+
+    const QString& socket_path() const noexcept;
+
+    static QString virtiofsd_path();
+
+    // Socket paths are limited to 107 bytes, too few to have them under instance directories
+    static QString socket_dir();
+
+private:
+    const QString tag;
+    const QString shared_dir;
+    const QString vhost_socket;
+    const QString cache_policy;
+    const IdMap uid_map;
+    const IdMap gid_map;
+};
+
+} // namespace multipass
+
+inline const QString& multipass::VirtiofsdProcessSpec::socket_path() const noexcept
+{
+    return vhost_socket;
+}
@@ -40,6 +40,7 @@
 #include <QRegularExpression>
 #include <QString>
 
+#include <algorithm>
 #include <chrono>
 #include <functional>
 #include <mutex>
@@ -61,6 +62,23 @@ constexpr auto head_filename = "snapshot-head";
 constexpr auto count_filename = "snapshot-count";
 constexpr auto yes_overwrite = true;
 
+// Waits in the instance, where checking is cheap, for up to the given number of seconds
+constexpr auto cloud_init_wait_cmd = "timeout {} sh -c 'until [ -e "
+                                     "/var/lib/cloud/instance/boot-finished ]; do sleep 0.1; done'";
+// Leaves a second of the SSH exit code timeout for the round trip, so that the exec is not given
+// up on before the instance replies, and lets aborted starts be noticed between execs
+constexpr auto max_cloud_init_wait_per_exec =
+    mp::SSHProcess::default_exit_code_timeout - std::chrono::seconds{1};
+static_assert(max_cloud_init_wait_per_exec >= std::chrono::seconds{1});
+
+constexpr auto max_spare_ssh_sessions = 2u;
+
+auto millis_since(std::chrono::steady_clock::time_point start)
+{
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+}
+
 void assert_vm_stopped([[maybe_unused]] St state)
 {
     assert(state == St::off || state == St::stopped);
@@ -245,6 +263,11 @@ std::unique_ptr<mp::SSHProcess> mp::BaseVirtualMachine::ssh_exec_process(const s
 {
     std::unique_lock lock{state_mutex};
 
+    // Checked first, because is_connected would wait for whoever holds the session
+    if (ssh_session && ssh_session->is_busy())
+        if (auto proc = exec_on_spare_ssh_session(lock, cmd, whisper))
+            return proc;
+
     std::optional<std::string> log_details = std::nullopt;
     bool reconnect = true;
     while (true)
@@ -286,6 +309,81 @@ std::unique_ptr<mp::SSHProcess> mp::BaseVirtualMachine::make_ssh_process(const s
     return ssh_session->exec(cmd, whisper);
 }
 
+std::unique_ptr<mp::SSHProcess> mp::BaseVirtualMachine::exec_on_spare_ssh_session(
+    std::unique_lock<std::mutex>& lock,
+    const std::string& cmd,
+    bool whisper)
+{
+    assert(lock.owns_lock());
+
+    // Sessions are picked under the state lock, so a session that is not busy can be claimed
+    // without waiting
+    for (auto it = spare_ssh_sessions.begin(); it != spare_ssh_sessions.end();)
+    {
+        auto& session = *it;
+        if (session->is_busy())
+        {
+            ++it;
+            continue;
+        }
+
+        try
+        {
+            if (session->is_connected())
+                return session->exec(cmd, whisper);
+        }
+        catch (const SSHException& e)
+        {
+            mpl::debug(vm_name, "Spare SSH session failed: {}", e.what());
+        }
+
+        it = spare_ssh_sessions.erase(it);
+    }
+
+    if (spare_ssh_sessions.size() + spare_ssh_sessions_opening >= max_spare_ssh_sessions)
+        return nullptr; // wait for the cached session instead
+
+    ++spare_ssh_sessions_opening;
+    const auto generation = ssh_session_generation.load();
+    lock.unlock();
+
+    std::unique_ptr<SSHSession> new_session;
+    try
+    {
+        new_session = new_ssh_session();
+    }
+    catch (const SSHException& e)
+    {
+        mpl::debug(vm_name, "Could not open spare SSH session: {}", e.what());
+    }
+
+    lock.lock();
+    --spare_ssh_sessions_opening;
+    if (!new_session)
+        return nullptr;
+
+    if (ssh_session_generation != generation)
+    {
+        // Sessions were dropped meanwhile, e.g. because the instance is going down
+        mpl::debug(vm_name, "Discarding spare SSH session opened before sessions were dropped");
+        return nullptr;
+    }
+
+    mpl::debug(vm_name, "Opened spare SSH session ({} open)", spare_ssh_sessions.size() + 1);
+    auto& session = spare_ssh_sessions.emplace_back(std::move(new_session));
+    try
+    {
+        return session->exec(cmd, whisper);
+    }
+    catch (const SSHException& e)
+    {
+        mpl::debug(vm_name, "Spare SSH session failed: {}", e.what());
+        spare_ssh_sessions.pop_back();
+    }
+
+    return nullptr;
+}
+
 void mp::BaseVirtualMachine::renew_ssh_session()
 {
     auto new_session = new_ssh_session();
@@ -348,20 +446,27 @@ void mp::BaseVirtualMachine::wait_until_ssh_up(std::chrono::milliseconds timeout
     drop_ssh_session();
     mpl::debug(vm_name, "Waiting for SSH to be up");
 
+    const auto start = std::chrono::steady_clock::now();
     auto action = std::bind_front(&BaseVirtualMachine::try_to_ssh, this);
     auto timeout_action = std::bind_front(&BaseVirtualMachine::timeout_ssh, this);
     mpu::try_action_for(timeout_action, timeout, action);
 
-    mpl::debug(vm_name, "Caching initial SSH session");
+    mpl::debug(vm_name, "SSH up after {}ms, caching initial SSH session", millis_since(start));
 }
 
 void mp::BaseVirtualMachine::wait_for_cloud_init(std::chrono::milliseconds timeout)
 {
-    auto action = [this] {
+    using namespace std::chrono;
+
+    const auto start = steady_clock::now();
+    const auto deadline = start + timeout;
+    auto action = [this, deadline] {
         detect_aborted_start();
         try
         {
-            ssh_exec("[ -e /var/lib/cloud/instance/boot-finished ]");
+            const auto remaining = ceil<seconds>(deadline - steady_clock::now());
+            const auto guest_wait = std::clamp(remaining, 1s, max_cloud_init_wait_per_exec);
+            ssh_exec(fmt::format(cloud_init_wait_cmd, guest_wait.count()));
             return mpu::TimeoutAction::done;
         }
         catch (const SSHVMNotRunning& e)
@@ -380,10 +485,22 @@ void mp::BaseVirtualMachine::wait_for_cloud_init(std::chrono::milliseconds timeo
         }
     };
 
-    auto on_timeout = [] {
-        throw std::runtime_error("timed out waiting for initialization to complete");
-    };
-    mpu::try_action_for(on_timeout, timeout, action);
+    // unlike other waits, retry quickly at first, since the instance is usually almost ready by now
+    // - mock this to avoid sleeping at all in tests
+    milliseconds retry_interval = 100ms;
+    while (steady_clock::now() < deadline)
+    {
+        if (action() == mpu::TimeoutAction::done)
+        {
+            mpl::debug(vm_name, "Initialization completed after {}ms", millis_since(start));
+            return;
+        }
+
+        MP_UTILS.sleep_for(std::min(retry_interval, timeout));
+        retry_interval = std::min<milliseconds>(retry_interval * 2, 1s);
+    }
+
+    throw std::runtime_error("timed out waiting for initialization to complete");
 }
 
 void mp::BaseVirtualMachine::resize_disk(const MemorySize& new_size, mp::UserMessages& messages)
@@ -395,27 +512,11 @@ void mp::BaseVirtualMachine::resize_disk(const MemorySize& new_size, mp::UserMes
 
 auto mp::BaseVirtualMachine::get_all_ipv4() -> std::vector<IPAddress>
 {
-    std::vector<IPAddress> all_ipv4;
-
     if (MP_UTILS.is_running(current_state()))
     {
         try
         {
-            auto ip_a_output = QString::fromStdString(
-                ssh_exec("ip -brief -family inet address show scope global", /* whisper = */ true));
-
-            QRegularExpression ipv4_re{QStringLiteral("([\\d\\.]+)\\/\\d+\\s*(metric \\d+)?\\s*$"),
-                                       QRegularExpression::MultilineOption};
-
-            QRegularExpressionMatchIterator ip_it = ipv4_re.globalMatch(ip_a_output);
-
-            while (ip_it.hasNext())
-            {
-                auto ip_match = ip_it.next();
-                auto ip_str = ip_match.captured(1).toStdString();
-
-                all_ipv4.push_back(IPAddress{ip_str});
-            }
+            return all_ipv4_from(ssh_exec(all_ipv4_cmd, /* whisper = */ true));
         }
         catch (const SSHException& e)
         {
@@ -423,6 +524,28 @@ auto mp::BaseVirtualMachine::get_all_ipv4() -> std::vector<IPAddress>
         }
     }
 
+    return {};
+}
+
+auto mp::BaseVirtualMachine::all_ipv4_from(const std::string& all_ipv4_cmd_output)
+    -> std::vector<IPAddress>
+{
+    std::vector<IPAddress> all_ipv4;
+
+    QRegularExpression ipv4_re{QStringLiteral("([\\d\\.]+)\\/\\d+\\s*(metric \\d+)?\\s*$"),
+                               QRegularExpression::MultilineOption};
+
+    QRegularExpressionMatchIterator ip_it =
+        ipv4_re.globalMatch(QString::fromStdString(all_ipv4_cmd_output));
+
+    while (ip_it.hasNext())
+    {
+        auto ip_match = ip_it.next();
+        auto ip_str = ip_match.captured(1).toStdString();
+
+        all_ipv4.push_back(IPAddress{ip_str});
+    }
+
     return all_ipv4;
 }
 
@@ -513,7 +636,8 @@ std::shared_ptr<const mp::Snapshot> mp::BaseVirtualMachine::take_snapshot(
     const std::string& comment)
 {
     std::unique_lock lock{snapshot_mutex};
-    assert_vm_stopped(state); // precondition
+    if (state != St::running || !supports_live_snapshots())
+        assert_vm_stopped(state); // precondition
 
     auto sname = snapshot_name.empty() ? generate_snapshot_name() : snapshot_name;
 
@@ -912,6 +1036,9 @@ void mp::BaseVirtualMachine::drop_ssh_session()
         mpl::debug(vm_name, "Dropping cached SSH session");
         ssh_session.reset();
     }
+
+    spare_ssh_sessions.clear();
+    ++ssh_session_generation; // so that spare sessions still being opened are not kept
 }
 
 auto mp::BaseVirtualMachine::try_to_ssh() -> utils::TimeoutAction
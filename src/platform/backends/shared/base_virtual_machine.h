@@ -27,10 +27,12 @@
 #include <multipass/virtual_machine.h>
 #include <multipass/virtual_machine_description.h>
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <unordered_map>
+#include <vector>
 
 namespace multipass
 {
@@ -64,6 +66,7 @@ public:
 
     void resize_disk(const MemorySize& new_size, UserMessages& messages) override;
     std::vector<IPAddress> get_all_ipv4() override;
+    std::vector<IPAddress> all_ipv4_from(const std::string& all_ipv4_cmd_output) override;
     void add_network_interface(int, const std::string&, const NetworkInterface&) override
     {
         throw NotImplementedOnThisBackendException("networks");
@@ -82,6 +85,11 @@ public:
     std::shared_ptr<Snapshot> get_snapshot(const std::string& name) override;
     std::shared_ptr<Snapshot> get_snapshot(int index) override;
 
+    bool supports_live_snapshots() const override
+    {
+        return false;
+    }
+
     // TODO: the VM should know its directory, but that is true of everything in its VMDescription;
     // pulling that from derived classes is a big refactor
     std::shared_ptr<const Snapshot> take_snapshot(const VMSpecs& specs,
@@ -126,6 +134,9 @@ protected:
     virtual void refresh_start();
 
     void renew_ssh_session();
+    std::unique_ptr<SSHProcess> exec_on_spare_ssh_session(std::unique_lock<std::mutex>& lock,
+                                                          const std::string& cmd,
+                                                          bool whisper);
     void detect_aborted_start();
     void save_error_msg(std::string error) noexcept;
     IPAddress require_management_ipv4();
@@ -205,6 +216,10 @@ protected:
 private:
     std::string saved_error_msg = "";
     std::unique_ptr<SSHSession> ssh_session = nullptr;
+    // Opened on demand while ssh_session is busy, so that commands don't queue behind each other
+    std::vector<std::unique_ptr<SSHSession>> spare_ssh_sessions;
+    std::size_t spare_ssh_sessions_opening{0};
+    std::atomic_size_t ssh_session_generation{0}; // bumped whenever sessions are dropped
     SnapshotMap snapshots;
     std::shared_ptr<Snapshot> head_snapshot = nullptr;
     int snapshot_count = 0; // tracks the number of snapshots ever taken (regardless of deletes)
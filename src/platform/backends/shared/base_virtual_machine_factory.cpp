@@ -20,6 +20,7 @@
 
 #include <multipass/cloud_init_iso.h>
 #include <multipass/constants.h>
+#include <multipass/file_ops.h>
 #include <multipass/network_interface.h>
 #include <multipass/network_interface_info.h>
 #include <multipass/virtual_machine_description.h>
@@ -144,7 +145,8 @@ void mp::BaseVirtualMachineFactory::copy_instance_dir_with_essential_files(
         if (cloneable_files.contains(ext))
         {
             const fs::path dest_file_path = dest_instance_dir_path / entry.path().filename();
-            fs::copy(entry.path(), dest_file_path, fs::copy_options::update_existing);
+            // goes through FileOps so that images are reflinked rather than duplicated when possible
+            MP_FILEOPS.copy(entry.path(), dest_file_path, fs::copy_options::update_existing);
         }
     }
 }
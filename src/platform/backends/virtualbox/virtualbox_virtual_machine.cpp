@@ -511,12 +511,11 @@ std::optional<mp::IPAddress> mp::VirtualBoxVirtualMachine::management_ipv4()
     return std::nullopt;
 }
 
-std::vector<mp::IPAddress> mp::VirtualBoxVirtualMachine::get_all_ipv4()
+std::vector<mp::IPAddress> mp::VirtualBoxVirtualMachine::all_ipv4_from(
+    const std::string& all_ipv4_cmd_output)
 {
-    using namespace std;
-
     const auto internal_ip = IPAddress{"10.0.2.15"};
-    auto all_ipv4 = BaseVirtualMachine::get_all_ipv4();
+    auto all_ipv4 = BaseVirtualMachine::all_ipv4_from(all_ipv4_cmd_output);
     std::erase(all_ipv4, internal_ip);
 
     return all_ipv4;
@@ -57,7 +57,7 @@ public:
     std::string ssh_hostname() override;
     std::string ssh_username() override;
     std::optional<IPAddress> management_ipv4() override;
-    std::vector<IPAddress> get_all_ipv4() override;
+    std::vector<IPAddress> all_ipv4_from(const std::string& all_ipv4_cmd_output) override;
     void handle_state_update() override;
     void update_cpus(int num_cores) override;
     void resize_memory(const MemorySize& new_size) override;
@@ -24,3 +24,8 @@ namespace mpl = multipass::logging;
 mpl::LinuxLogger::LinuxLogger(mpl::Level level) : Logger{level}
 {
 }
+
+bool mpl::LinuxLogger::accepts(mpl::Level level) const
+{
+    return level <= logging_level;
+}
@@ -28,6 +28,7 @@ class LinuxLogger : public Logger
 {
 public:
     explicit LinuxLogger(Level level);
+    bool accepts(Level level) const override;
 
 protected:
     static constexpr auto to_syslog_priority(Level level) noexcept
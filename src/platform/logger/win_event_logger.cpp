@@ -102,3 +102,8 @@ void mpl::EventLogger::log(mpl::Level level,
                     raw_data);
     }
 }
+
+bool mpl::EventLogger::accepts(mpl::Level level) const
+{
+    return level <= logging_level;
+}
@@ -28,6 +28,7 @@ class EventLogger : public Logger
 public:
     explicit EventLogger(Level level);
     void log(Level level, std::string_view category, std::string_view message) const override;
+    bool accepts(Level level) const override;
 
 private:
     Level logging_level;
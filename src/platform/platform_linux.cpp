@@ -24,6 +24,7 @@
 #include <multipass/logging/log.h>
 #include <multipass/platform.h>
 #include <multipass/process/qemuimg_process_spec.h>
+#include <multipass/settings/custom_setting_spec.h>
 #include <multipass/settings/settings.h>
 #include <multipass/snap_utils.h>
 #include <multipass/standard_paths.h>
@@ -31,6 +32,7 @@
 #include <multipass/virtual_machine_factory.h>
 
 #include "backends/qemu/qemu_virtual_machine_factory.h"
+#include "backends/qemu/virtiofsd_process_spec.h"
 
 #ifdef VIRTUALBOX_ENABLED
 #include "backends/virtualbox/virtualbox_virtual_machine_factory.h"
@@ -50,12 +52,14 @@
 #include <QCoreApplication>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QRegularExpression>
 #include <QString>
 #include <QTextStream>
 
 #include <errno.h>
 #include <linux/if_arp.h>
+#include <map>
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -321,7 +325,17 @@ void mp::platform::Platform::remove_alias_script(const std::string& alias) const
 
 auto mp::platform::Platform::extra_daemon_settings() const -> SettingSpec::Set
 {
-    return {};
+    SettingSpec::Set ret;
+    for (const auto& [key, default_] :
+         {std::pair{native_mount_transport_key, native_mount_transport_9p},
+          std::pair{virtiofs_cache_key, virtiofs_cache_default}})
+    {
+        ret.insert(std::make_unique<CustomSettingSpec>(key, default_, [key](const QString& val) {
+            return interpret_setting(key, val);
+        }));
+    }
+
+    return ret;
 }
 
 auto mp::platform::Platform::extra_client_settings() const -> SettingSpec::Set
@@ -424,6 +438,29 @@ auto mp::platform::detail::get_network_interfaces_from(const QDir& sys_dir)
 
 QString mp::platform::interpret_setting(const QString& key, const QString& val)
 {
+    static const auto acceptable_values = std::map<QString, QStringList>{
+        {native_mount_transport_key, {native_mount_transport_9p, native_mount_transport_virtiofs}},
+        {virtiofs_cache_key, {"auto", "always", "never", "metadata"}}};
+
+    if (auto it = acceptable_values.find(key); it != acceptable_values.end())
+    {
+        auto ret = val.toLower();
+        if (!it->second.contains(ret))
+            throw InvalidSettingException{
+                key,
+                val,
+                QStringLiteral("Unknown value. Try one of these: %1.").arg(it->second.join(", "))};
+
+        if (key == native_mount_transport_key && ret == native_mount_transport_virtiofs &&
+            !MP_FILEOPS.exists(QFileInfo{VirtiofsdProcessSpec::virtiofsd_path()}))
+            throw InvalidSettingException{
+                key,
+                val,
+                QStringLiteral("%1 is not installed").arg(VirtiofsdProcessSpec::virtiofsd_path())};
+
+        return ret;
+    }
+
     // this should not happen (settings should have found it to be an invalid key)
     throw InvalidSettingException(key, val, "Setting unavailable on Linux");
 }
@@ -41,6 +41,7 @@ mp::DefaultUpdatePrompt::~DefaultUpdatePrompt() = default;
 
 bool mp::DefaultUpdatePrompt::is_time_to_show()
 {
+    std::lock_guard lock{last_shown_mutex};
     return monitor->get_new_release() &&
            last_shown + ::notify_user_frequency < std::chrono::system_clock::now();
 }
@@ -54,6 +55,8 @@ void mp::DefaultUpdatePrompt::populate(mp::UpdateInfo* update_info)
         update_info->set_url(new_release->url);
         update_info->set_title(new_release->title);
         update_info->set_description(new_release->description);
+
+        std::lock_guard lock{last_shown_mutex};
         last_shown = std::chrono::system_clock::now();
     }
 }
@@ -19,6 +19,7 @@
 
 #include <chrono>
 #include <memory>
+#include <mutex>
 #include <multipass/update_prompt.h>
 
 namespace multipass
@@ -41,5 +42,6 @@ public:
 private:
     std::unique_ptr<NewReleaseMonitor> monitor;
     std::chrono::system_clock::time_point last_shown;
+    std::mutex last_shown_mutex;
 };
 } // namespace multipass
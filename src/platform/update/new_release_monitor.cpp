@@ -104,6 +104,7 @@ mp::NewReleaseMonitor::~NewReleaseMonitor() = default;
 
 std::optional<mp::NewReleaseInfo> mp::NewReleaseMonitor::get_new_release() const
 {
+    std::lock_guard lock{release_mutex};
     return new_release;
 }
 
@@ -117,8 +118,13 @@ void mp::NewReleaseMonitor::latest_release_found(const NewReleaseInfo& latest_re
         // not of correct form, throw.
         if (current < latest)
         {
-            new_release = latest_release;
-            mpl::info("update", "A New Multipass release is available: {}", new_release->version);
+            {
+                std::lock_guard lock{release_mutex};
+                new_release = latest_release;
+            }
+            mpl::info("update",
+                      "A New Multipass release is available: {}",
+                      latest_release.version);
         }
     }
     catch (const std::invalid_argument& e)
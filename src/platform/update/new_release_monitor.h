@@ -23,6 +23,7 @@
 #include <QObject>
 #include <QTimer>
 
+#include <mutex>
 #include <optional>
 
 namespace multipass
@@ -60,6 +61,7 @@ private slots:
 private:
     const std::string current_version, update_url;
     std::optional<NewReleaseInfo> new_release;
+    mutable std::mutex release_mutex; // new_release can be read off the main thread
     QTimer refresh_timer;
 
     qt_delete_later_unique_ptr<LatestReleaseChecker> worker_thread;
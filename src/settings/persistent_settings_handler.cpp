@@ -23,6 +23,7 @@
 #include <multipass/settings/persistent_settings_handler.h>
 
 #include <cassert>
+#include <chrono>
 
 namespace mp = multipass;
 namespace mpl = mp::logging;
@@ -58,13 +59,27 @@ void check_status(const mp::WrappedQSettings& qsettings, const QString& attempte
                 : QStringLiteral("access error (consider running with an administrative role)")};
 }
 
+// File systems keep modification times with limited precision, so a file can be written again
+// within the same stamp that we cached it under
+constexpr auto stamp_granularity = std::chrono::seconds{1};
+
+std::optional<std::filesystem::file_time_type> file_stamp(const QString& filename)
+{
+    std::error_code err;
+    const auto stamp = MP_FILEOPS.last_write_time(filename.toStdU16String(), err);
+    return err ? std::nullopt : std::make_optional(stamp); // no stamp for a missing file
+}
+
+// Whether the stamp is old enough that any later write would change it
+bool settled(const std::optional<std::filesystem::file_time_type>& stamp)
+{
+    return !stamp || std::filesystem::file_time_type::clock::now() - *stamp >= stamp_granularity;
+}
+
 QString checked_get(mp::WrappedQSettings& qsettings,
                     const QString& key,
-                    const mp::SettingSpec& spec,
-                    std::mutex& mutex)
+                    const mp::SettingSpec& spec)
 {
-    std::lock_guard<std::mutex> lock{mutex};
-
     const auto& fallback = spec.get_default();
     auto ret = qsettings.value(key, fallback).toString();
 
@@ -86,13 +101,8 @@ QString checked_get(mp::WrappedQSettings& qsettings,
     return ret;
 }
 
-void checked_set(mp::WrappedQSettings& qsettings,
-                 const QString& key,
-                 const QString& val,
-                 std::mutex& mutex)
+void checked_set(mp::WrappedQSettings& qsettings, const QString& key, const QString& val)
 {
-    std::lock_guard<std::mutex> lock{mutex};
-
     qsettings.setValue(key, val);
 
     qsettings.sync(); // flush to confirm we can write
@@ -111,8 +121,26 @@ QString mp::PersistentSettingsHandler::get(const QString& key) const
 {
     const auto& setting_spec =
         get_setting(key); // make sure the key is valid before reading from disk
+
+    std::lock_guard<std::mutex> lock{mutex};
+
+    // A changed modification time means someone else wrote the file, so what we have may be stale.
+    // A file that became unreadable is read again too, so that the error is reported.
+    const auto stamp = file_stamp(filename);
+    if (stamp != cache_stamp || exists_but_unreadable(filename))
+    {
+        cache.clear();
+        cache_stamp = stamp;
+    }
+    else if (auto it = cache.find(key); it != cache.end())
+        return it->second;
+
     auto settings_file = persistent_settings(filename);
-    return checked_get(*settings_file, key, setting_spec, mutex);
+    auto ret = checked_get(*settings_file, key, setting_spec);
+    if (settled(stamp))
+        cache[key] = ret;
+
+    return ret;
 }
 
 auto mp::PersistentSettingsHandler::get_setting(const QString& key) const -> const SettingSpec&
@@ -134,8 +162,15 @@ void mp::PersistentSettingsHandler::set(const QString& key, const QString& val,
     auto interpreted = get_setting(key).interpret(
         val); // check both key and value validity, convert as appropriate
 
+    std::lock_guard<std::mutex> lock{mutex};
+
     auto settings_file = persistent_settings(filename);
-    checked_set(*settings_file, key, interpreted, mutex);
+    checked_set(*settings_file, key, interpreted);
+
+    cache.clear(); // we cannot tell whether anything else changed in the file since we last read it
+    cache_stamp = file_stamp(filename);
+    if (settled(cache_stamp))
+        cache[key] = interpreted;
 }
 
 std::set<QString> mp::PersistentSettingsHandler::keys() const
@@ -364,6 +364,39 @@ ssize_t mp::Libssh::sftp_write(sftp_file file, const void* buf, size_t count) co
     return ::sftp_write(file, buf, count);
 }
 
+int mp::Libssh::sftp_seek64(sftp_file file, uint64_t new_offset) const
+{
+    return ::sftp_seek64(file, new_offset);
+}
+
+ssize_t mp::Libssh::sftp_aio_begin_read(sftp_file file, size_t len, sftp_aio* aio) const
+{
+    return ::sftp_aio_begin_read(file, len, aio);
+}
+
+ssize_t mp::Libssh::sftp_aio_wait_read(sftp_aio* aio, void* buf, size_t buf_size) const
+{
+    return ::sftp_aio_wait_read(aio, buf, buf_size);
+}
+
+ssize_t mp::Libssh::sftp_aio_begin_write(sftp_file file,
+                                         const void* buf,
+                                         size_t len,
+                                         sftp_aio* aio) const
+{
+    return ::sftp_aio_begin_write(file, buf, len, aio);
+}
+
+ssize_t mp::Libssh::sftp_aio_wait_write(sftp_aio* aio) const
+{
+    return ::sftp_aio_wait_write(aio);
+}
+
+void mp::Libssh::sftp_aio_free(sftp_aio aio) const
+{
+    ::sftp_aio_free(aio);
+}
+
 int mp::Libssh::sftp_chmod(sftp_session sftp, const char* file, mode_t mode) const
 {
     return ::sftp_chmod(sftp, file, mode);
@@ -224,6 +224,12 @@ bool mp::PlainSSHSession::is_connected() const
     return session && static_cast<bool>(MP_LIBSSH.ssh_is_connected(session.get()));
 }
 
+bool mp::PlainSSHSession::is_busy() const
+{
+    std::unique_lock lock{mut, std::try_to_lock};
+    return !lock.owns_lock();
+}
+
 bool mp::PlainSSHSession::is_moved() const
 {
     return !session;
@@ -27,7 +27,9 @@
 #include <multipass/ssh/throw_on_error.h>
 #include <multipass/utils.h>
 
+#include <algorithm>
 #include <array>
+#include <deque>
 #include <fcntl.h>
 #include <fmt/std.h>
 #include <functional>
@@ -35,6 +37,18 @@
 constexpr int file_mode = 0664;
 const std::string stream_file_name{"stream_output.dat"};
 const char* log_category = "sftp";
+// Upper bound on the chunks of a single file that are requested before waiting for a reply.
+constexpr size_t max_requests_in_flight = 16;
+
+// Owns an outstanding asynchronous request; libssh releases it itself once it has been waited on.
+struct SFTPAioDeleter
+{
+    void operator()(sftp_aio aio) const
+    {
+        MP_LIBSSH.sftp_aio_free(aio);
+    }
+};
+using SFTPAioUPtr = std::unique_ptr<sftp_aio_struct, SFTPAioDeleter>;
 
 namespace multipass
 {
@@ -384,15 +398,39 @@ void SFTPClient::do_push_file(std::istream& source, const fs::path& target_path)
                         target_path,
                         MP_LIBSSH.ssh_get_error(sftp->session)};
 
-    // create an uninitialized buffer to use.
+    // create an uninitialized buffer to use. libssh copies the data out when sending a request,
+    // so the buffer can be refilled while earlier writes are still in flight.
     const auto max_write = mp_sftp_limits(sftp.get())->max_write_length;
     const std::unique_ptr<char[]> buffer{new char[max_write]};
 
+    std::deque<SFTPAioUPtr> pending;
+    auto wait_for_write = [&] {
+        auto aio = pending.front().release();
+        pending.pop_front();
+
+        const auto r = MP_LIBSSH.sftp_aio_wait_write(&aio);
+        const SFTPAioUPtr leftover{aio};
+        if (r < 0)
+            throw SFTPError{"cannot write to remote file {}: {}",
+                            target_path,
+                            MP_LIBSSH.ssh_get_error(sftp->session)};
+    };
+
     while (auto r = source.read(buffer.get(), max_write).gcount())
-        if (MP_LIBSSH.sftp_write(remote_file.get(), buffer.get(), r) < 0)
+    {
+        if (pending.size() == max_requests_in_flight)
+            wait_for_write();
+
+        sftp_aio aio = nullptr;
+        if (MP_LIBSSH.sftp_aio_begin_write(remote_file.get(), buffer.get(), r, &aio) < 0)
             throw SFTPError{"cannot write to remote file {}: {}",
                             target_path,
                             MP_LIBSSH.ssh_get_error(sftp->session)};
+        pending.emplace_back(aio);
+    }
+
+    while (!pending.empty())
+        wait_for_write();
 }
 
 void SFTPClient::do_pull_file(const fs::path& source_path, std::ostream& target)
@@ -407,15 +445,63 @@ void SFTPClient::do_pull_file(const fs::path& source_path, std::ostream& target)
     const auto max_read = mp_sftp_limits(sftp.get())->max_read_length;
     const std::unique_ptr<char[]> buffer{new char[max_read]};
 
-    while (auto r = MP_LIBSSH.sftp_read(remote_file.get(), buffer.get(), max_read))
+    // Reads are pipelined with a window that starts at a single request and grows while the server
+    // keeps returning full chunks, so small files cost no more round trips than before.
+    std::deque<SFTPAioUPtr> pending;
+    size_t window = 1;
+    uint64_t offset = 0;
+
+    auto wait_for_read = [&] {
+        auto aio = pending.front().release();
+        pending.pop_front();
+
+        const auto r = MP_LIBSSH.sftp_aio_wait_read(&aio, buffer.get(), max_read);
+        const SFTPAioUPtr leftover{aio};
+        return r;
+    };
+    auto drain = [&] {
+        while (!pending.empty())
+            wait_for_read();
+    };
+
+    while (true)
     {
+        while (pending.size() < window)
+        {
+            sftp_aio aio = nullptr;
+            if (MP_LIBSSH.sftp_aio_begin_read(remote_file.get(), max_read, &aio) < 0)
+                throw SFTPError{"cannot read from remote file {}: {}",
+                                source_path,
+                                MP_LIBSSH.ssh_get_error(sftp->session)};
+            pending.emplace_back(aio);
+        }
+
+        const auto r = wait_for_read();
         if (r < 0)
             throw SFTPError{"cannot read from remote file {}: {}",
                             source_path,
                             MP_LIBSSH.ssh_get_error(sftp->session)};
+        if (r == 0)
+            break;
 
         target.write(buffer.get(), r);
+        offset += r;
+
+        if (static_cast<size_t>(r) == max_read)
+        {
+            window = std::min(window * 2, max_requests_in_flight);
+        }
+        else
+        {
+            // A short read leaves a gap before the requests already in flight, so drop them and
+            // carry on sequentially from where the data stopped.
+            drain();
+            window = 1;
+            MP_LIBSSH.sftp_seek64(remote_file.get(), offset);
+        }
     }
+
+    drain();
 }
 
 } // namespace multipass
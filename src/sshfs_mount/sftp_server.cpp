@@ -31,6 +31,7 @@
 #include <QFile>
 
 #include <fcntl.h>
+#include <sys/stat.h>
 
 namespace mp = multipass;
 namespace mpl = multipass::logging;
@@ -42,6 +43,18 @@ constexpr auto category = "sftp server";
 using SftpHandleUPtr = std::unique_ptr<ssh_string_struct, void (*)(ssh_string)>;
 using namespace std::literals::chrono_literals;
 
+constexpr uint32_t max_packet_size = 65536u;
+constexpr uint32_t min_read_ahead_window = 128u * 1024u;
+constexpr uint32_t max_read_ahead_window = 1024u * 1024u;
+constexpr size_t max_spare_read_ahead_buffers = 4u;
+
+// The SFTP drafts only guarantee support for packets of at least 34000 bytes, so directory listings
+// are batched up to a little under that, rather than by number of entries.
+constexpr size_t max_names_reply_size = 32u * 1024u;
+constexpr size_t name_entry_overhead = 4u + 4u + 32u; // string lengths and attributes
+constexpr auto attribute_cache_ttl = 1s;
+constexpr size_t max_cached_attributes = 16384u;
+
 enum Permissions
 {
     read_user = 0400,
@@ -272,6 +285,26 @@ int reverse_id_for(const mp::id_mappings& id_maps, const int id, const int defau
              : found->first;
 }
 
+constexpr bool modifies_files(uint8_t type)
+{
+    switch (type)
+    {
+    case SSH_FXP_OPEN:
+    case SSH_FXP_WRITE:
+    case SSH_FXP_SETSTAT:
+    case SSH_FXP_FSETSTAT:
+    case SSH_FXP_REMOVE:
+    case SSH_FXP_MKDIR:
+    case SSH_FXP_RMDIR:
+    case SSH_FXP_RENAME:
+    case SSH_FXP_SYMLINK:
+    case SSH_FXP_EXTENDED:
+        return true;
+    default:
+        return false;
+    }
+}
+
 constexpr bool follows_symlinks(uint8_t type)
 {
     switch (type)
@@ -311,6 +344,7 @@ mp::SftpServer::SftpServer(std::unique_ptr<SSHSession>&& session,
                                                 ->release_channel())}, // TODO@rewiressh no cast
       source_path{MP_FILEOPS.weakly_canonical(source)},
       target_path{fs::path(target).lexically_normal()},
+      packet_buffer(max_packet_size),
       gid_mappings{gid_mappings},
       uid_mappings{uid_mappings},
       default_uid{default_uid},
@@ -497,6 +531,9 @@ void mp::SftpServer::process_message(sftp_client_message msg)
 {
     int ret = 0;
     const auto type = MP_LIBSSH.sftp_client_message_get_type(msg);
+    if (modifies_files(type))
+        attribute_cache.clear();
+
     switch (type)
     {
     case SFTP_REALPATH:
@@ -633,6 +670,7 @@ void mp::SftpServer::stop()
 int mp::SftpServer::handle_close(sftp_client_message msg)
 {
     const auto id = MP_LIBSSH.sftp_handle(sftp_server_session.get(), msg->handle);
+    discard_read_ahead(id);
     if (!open_file_handles.erase(id) && !open_dir_handles.erase(id))
     {
         mpl::trace(category, "{}: bad handle requested", __FUNCTION__);
@@ -664,6 +702,12 @@ int mp::SftpServer::handle_fstat(sftp_client_message msg)
         return reply_perm_denied(msg);
     }
 
+    if (auto cached = cached_attributes_for(path, true))
+    {
+        auto attr = *cached;
+        return MP_LIBSSH.sftp_reply_attr(msg, &attr);
+    }
+
     QFileInfo file_info(path);
 
     if (file_info.isSymLink())
@@ -906,32 +950,135 @@ int mp::SftpServer::handle_read(sftp_client_message msg)
     }
 
     const auto& [path, file] = *handle;
+    const auto len = std::min(msg->len, max_packet_size);
+    auto& read_ahead = read_aheads[handle];
 
-    if (MP_FILEOPS.lseek(file, msg->offset, SEEK_SET) == -1)
+    // Data read ahead is only good while the file stays the same, but it can also change on the
+    // host or through another handle. Read it again if so, still in sequence.
+    if (read_ahead.covers(msg->offset, len) &&
+        (!read_ahead.version || read_ahead.version != file_version(file)))
+        read_ahead.size = 0;
+
+    const char* data = nullptr;
+    int r = 0;
+    if (read_ahead.covers(msg->offset, len))
     {
-        mpl::trace(category,
-                   "{}: cannot seek to position {} in '{}'",
-                   __FUNCTION__,
-                   msg->offset,
-                   path.string());
-        return reply_failure(msg);
+        data = read_ahead.buffer.data() + (msg->offset - read_ahead.start);
+        r = static_cast<int>(len);
+    }
+    else if (msg->offset == read_ahead.next_offset)
+    {
+        data = read_ahead.buffer.data();
+        r = std::min(fill_read_ahead(read_ahead, file, msg->offset, len), static_cast<int>(len));
+    }
+    else
+    {
+        release_read_ahead(read_ahead);
+        data = packet_buffer.data();
+        r = MP_FILEOPS.pread(file, packet_buffer.data(), len, msg->offset);
     }
 
-    constexpr auto max_packet_size = 65536u;
-    std::array<char, max_packet_size> buffer{};
-
-    if (const auto r = MP_FILEOPS.read(file, buffer.data(), std::min(msg->len, max_packet_size));
-        r > 0)
-        return MP_LIBSSH.sftp_reply_data(msg, buffer.data(), r);
+    if (r > 0)
+    {
+        read_ahead.next_offset = msg->offset + r;
+        return MP_LIBSSH.sftp_reply_data(msg, data, r);
+    }
     else if (r == 0)
         return MP_LIBSSH.sftp_reply_status(msg, SSH_FX_EOF, "End of file");
 
+    const auto err = errno;
+    discard_read_ahead(handle);
     mpl::trace(category,
                "{}: read failed for '{}': {}",
                __FUNCTION__,
                path.string(),
-               std::strerror(errno));
-    return MP_LIBSSH.sftp_reply_status(msg, SSH_FX_FAILURE, std::strerror(errno));
+               std::strerror(err));
+    return MP_LIBSSH.sftp_reply_status(msg, SSH_FX_FAILURE, std::strerror(err));
+}
+
+bool mp::SftpServer::ReadAhead::covers(uint64_t offset, uint32_t len) const
+{
+    return offset >= start && offset + len <= start + size;
+}
+
+// Reads at least `len` bytes at `offset` into `read_ahead`, for a client that keeps reading where
+// its previous read ended. The window of data read ahead doubles with each refill, up to
+// `max_read_ahead_window`, so that subsequent requests are served without syscalls.
+int mp::SftpServer::fill_read_ahead(ReadAhead& read_ahead, int fd, uint64_t offset, uint32_t len)
+{
+    if (read_ahead.buffer.empty())
+    {
+        if (spare_read_ahead_buffers.empty())
+            read_ahead.buffer.resize(max_read_ahead_window);
+        else
+        {
+            read_ahead.buffer = std::move(spare_read_ahead_buffers.back());
+            spare_read_ahead_buffers.pop_back();
+        }
+    }
+
+    read_ahead.window =
+        std::clamp(read_ahead.window * 2, min_read_ahead_window, max_read_ahead_window);
+    read_ahead.start = offset;
+    read_ahead.size = 0;
+    read_ahead.version = file_version(fd);
+
+    const auto wanted = std::max(read_ahead.window, len);
+    while (read_ahead.size < wanted)
+    {
+        const auto r = MP_FILEOPS.pread(fd,
+                                        read_ahead.buffer.data() + read_ahead.size,
+                                        wanted - read_ahead.size,
+                                        offset + read_ahead.size);
+        if (r < 0)
+            return r;
+        if (r == 0)
+            break;
+
+        read_ahead.size += r;
+    }
+
+    return static_cast<int>(read_ahead.size);
+}
+
+auto mp::SftpServer::file_version(int fd) -> std::optional<FileVersion>
+{
+    struct stat st{};
+    if (MP_FILEOPS.fstat(fd, &st) != 0)
+        return std::nullopt;
+
+#if defined(MULTIPASS_PLATFORM_WINDOWS)
+    return FileVersion{st.st_size, st.st_mtime, 0};
+#elif defined(MULTIPASS_PLATFORM_APPLE)
+    return FileVersion{st.st_size, st.st_mtimespec.tv_sec, st.st_mtimespec.tv_nsec};
+#else
+    return FileVersion{st.st_size, st.st_mtim.tv_sec, st.st_mtim.tv_nsec};
+#endif
+}
+
+void mp::SftpServer::release_read_ahead(ReadAhead& read_ahead)
+{
+    if (!read_ahead.buffer.empty() &&
+        spare_read_ahead_buffers.size() < max_spare_read_ahead_buffers)
+        spare_read_ahead_buffers.push_back(std::move(read_ahead.buffer));
+
+    read_ahead = {};
+}
+
+void mp::SftpServer::discard_read_ahead(void* handle)
+{
+    if (auto it = read_aheads.find(handle); it != read_aheads.end())
+    {
+        release_read_ahead(it->second);
+        read_aheads.erase(it);
+    }
+}
+
+void mp::SftpServer::invalidate_read_ahead(const fs::path& path)
+{
+    for (auto& [handle, read_ahead] : read_aheads)
+        if (static_cast<const NamedFd*>(handle)->path == path)
+            release_read_ahead(read_ahead);
 }
 
 int mp::SftpServer::handle_readdir(sftp_client_message msg)
@@ -948,8 +1095,7 @@ int mp::SftpServer::handle_readdir(sftp_client_message msg)
     if (!dir_iterator.hasNext())
         return MP_LIBSSH.sftp_reply_status(msg, SSH_FX_EOF, nullptr);
 
-    const auto max_num_entries_per_packet = 50ll;
-    for (int i = 0; i < max_num_entries_per_packet && dir_iterator.hasNext(); i++)
+    for (size_t reply_size = 0; reply_size < max_names_reply_size && dir_iterator.hasNext();)
     {
         const auto& entry = dir_iterator.next();
         QFileInfo file_info(entry.path());
@@ -966,15 +1112,48 @@ int mp::SftpServer::handle_readdir(sftp_client_message msg)
             attr = attr_from(file_info);
         }
         const auto longname = longname_from(file_info, entry.path().string());
-        MP_LIBSSH.sftp_reply_names_add(msg,
-                                       entry.path().filename().string().c_str(),
-                                       longname.data(),
-                                       &attr);
+        const auto name = entry.path().filename().string();
+        MP_LIBSSH.sftp_reply_names_add(msg, name.c_str(), longname.data(), &attr);
+        cache_attributes(entry.path(), attr, entry.is_symlink());
+
+        reply_size += name.size() + longname.size() + name_entry_overhead;
     }
 
     return MP_LIBSSH.sftp_reply_names(msg);
 }
 
+// Gives the attributes recorded for `path` by a recent directory listing, if any. Symlinks are
+// listed with their own attributes, so they can only answer requests that do not follow them.
+const sftp_attributes_struct* mp::SftpServer::cached_attributes_for(const fs::path& path,
+                                                                    bool follow) const
+{
+    const auto it = attribute_cache.find(path.lexically_normal().string());
+    if (it == attribute_cache.end() || it->second.expiry < std::chrono::steady_clock::now() ||
+        (follow && it->second.is_symlink))
+        return nullptr;
+
+    return &it->second.attr;
+}
+
+void mp::SftpServer::cache_attributes(const fs::path& path,
+                                      const sftp_attributes_struct& attr,
+                                      bool is_symlink)
+{
+    const auto now = std::chrono::steady_clock::now();
+    if (attribute_cache.size() >= max_cached_attributes)
+    {
+        std::erase_if(attribute_cache, [now](const auto& entry) {
+            return entry.second.expiry < now;
+        });
+
+        if (attribute_cache.size() >= max_cached_attributes)
+            attribute_cache.clear();
+    }
+
+    attribute_cache.insert_or_assign(path.lexically_normal().string(),
+                                     CachedAttributes{attr, is_symlink, now + attribute_cache_ttl});
+}
+
 int mp::SftpServer::handle_readlink(sftp_client_message msg)
 {
     const auto filename = get_validated_path(msg);
@@ -1183,6 +1362,8 @@ int mp::SftpServer::handle_setstat(sftp_client_message msg)
 
     if (msg->attr->flags & SSH_FILEXFER_ATTR_SIZE)
     {
+        invalidate_read_ahead(filename);
+
         QFile file{filename};
         if (!MP_FILEOPS.resize(file, msg->attr->size))
         {
@@ -1248,6 +1429,12 @@ int mp::SftpServer::handle_stat(sftp_client_message msg, const bool follow)
     if (!filename.has_value())
         return reply_perm_denied(msg);
 
+    if (auto cached = cached_attributes_for(*filename, follow))
+    {
+        auto attr = *cached;
+        return MP_LIBSSH.sftp_reply_attr(msg, &attr);
+    }
+
     QFileInfo file_info(*filename);
     if (!file_info.isSymLink() && !MP_FILEOPS.exists(file_info))
     {
@@ -1338,6 +1525,7 @@ int mp::SftpServer::handle_write(sftp_client_message msg)
     }
 
     const auto& [path, file] = *handle;
+    invalidate_read_ahead(path);
 
     if (MP_FILEOPS.lseek(file, msg->offset, SEEK_SET) == -1)
     {
@@ -23,8 +23,14 @@
 
 #include <libssh/sftp.h>
 
+#include <chrono>
+#include <limits>
 #include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
 #include <unordered_map>
+#include <vector>
 
 #include <QFile>
 #include <QFileInfo>
@@ -93,6 +99,42 @@ private:
     template <typename T>
     T* get_handle(sftp_client_message msg);
 
+    // The size and modification time (seconds, nanoseconds) of an open file
+    using FileVersion = std::tuple<int64_t, int64_t, int64_t>;
+    static std::optional<FileVersion> file_version(int fd);
+
+    // Data read ahead of the client for a file handle that is being read sequentially
+    struct ReadAhead
+    {
+        uint64_t start{0};
+        uint64_t next_offset{std::numeric_limits<uint64_t>::max()};
+        uint32_t window{0};
+        size_t size{0};
+        std::vector<char> buffer;
+        std::optional<FileVersion> version; // of the file when the buffer was filled
+
+        bool covers(uint64_t offset, uint32_t len) const;
+    };
+
+    int fill_read_ahead(ReadAhead& read_ahead, int fd, uint64_t offset, uint32_t len);
+    void release_read_ahead(ReadAhead& read_ahead);
+    void discard_read_ahead(void* handle);
+    void invalidate_read_ahead(const fs::path& path);
+
+    // Attributes gathered while listing a directory, so that the stat calls that usually follow
+    // can be answered without touching the file system again
+    struct CachedAttributes
+    {
+        sftp_attributes_struct attr;
+        bool is_symlink;
+        std::chrono::steady_clock::time_point expiry;
+    };
+
+    const sftp_attributes_struct* cached_attributes_for(const fs::path& path, bool follow) const;
+    void cache_attributes(const fs::path& path,
+                          const sftp_attributes_struct& attr,
+                          bool is_symlink);
+
     std::unique_ptr<SSHSession> ssh_session;
     SSHFSProcUptr sshfs_process;
     SftpSessionUptr sftp_server_session;
@@ -100,6 +142,10 @@ private:
     const std::filesystem::path target_path;
     std::unordered_map<void*, std::unique_ptr<NamedFd>> open_file_handles;
     std::unordered_map<void*, std::unique_ptr<DirIterator>> open_dir_handles;
+    std::unordered_map<void*, ReadAhead> read_aheads;
+    std::vector<std::vector<char>> spare_read_ahead_buffers;
+    std::vector<char> packet_buffer;
+    std::unordered_map<std::string, CachedAttributes> attribute_cache;
     const id_mappings gid_mappings;
     const id_mappings uid_mappings;
     const int default_uid;
@@ -27,6 +27,14 @@
 #include <thread>
 
 #include <fcntl.h>
+#include <sys/stat.h>
+
+#if defined(MULTIPASS_PLATFORM_LINUX)
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#elif defined(MULTIPASS_PLATFORM_APPLE)
+#include <sys/clonefile.h>
+#endif
 
 namespace mp = multipass;
 namespace mpl = multipass::logging;
@@ -64,6 +72,25 @@ private:
 
 thread_local std::mt19937 BackoffTimer::rng(std::random_device{}());
 
+// Whether a copy with these options may be done by cloning src (see FileOps::clone_file). Only
+// plain file copies into a fresh destination qualify; everything else keeps the semantics of
+// std::filesystem::copy. In particular, a symlink copied with copy_symlinks must be recreated as a
+// link rather than cloned from its target.
+bool can_clone_file(const fs::path& src, const fs::path& dist, fs::copy_options copy_options)
+{
+    using enum fs::copy_options;
+    if ((copy_options & (directories_only | create_symlinks | create_hard_links)) != none)
+        return false;
+
+    std::error_code ec;
+    const auto src_status = (copy_options & copy_symlinks) != none ? fs::symlink_status(src, ec)
+                                                                     : fs::status(src, ec);
+    if (!fs::is_regular_file(src_status))
+        return false;
+
+    return fs::symlink_status(dist, ec).type() == fs::file_type::not_found;
+}
+
 } // namespace
 
 mp::NamedFd::NamedFd(const fs::path& path, int fd) : path{path}, fd{fd}
@@ -315,6 +342,19 @@ int mp::FileOps::read(int fd, void* buf, size_t nbytes) const
     return ::read(fd, buf, nbytes);
 }
 
+int mp::FileOps::pread(int fd, void* buf, size_t nbytes, off_t offset) const
+{
+#ifdef MULTIPASS_PLATFORM_WINDOWS
+    // There is no positional read in the CRT, so this falls back to moving the file pointer
+    if (::lseek(fd, offset, SEEK_SET) == -1)
+        return -1;
+
+    return ::read(fd, buf, nbytes);
+#else
+    return ::pread(fd, buf, nbytes, offset);
+#endif
+}
+
 int mp::FileOps::write(int fd, const void* buf, size_t nbytes) const
 {
     return ::write(fd, buf, nbytes);
@@ -325,6 +365,11 @@ off_t mp::FileOps::lseek(int fd, off_t offset, int whence) const
     return ::lseek(fd, offset, whence);
 }
 
+int mp::FileOps::fstat(int fd, struct stat* buf) const
+{
+    return ::fstat(fd, buf);
+}
+
 void mp::FileOps::open(std::fstream& stream,
                        const std::filesystem::path& filename,
                        std::ios_base::openmode mode) const
@@ -369,10 +414,48 @@ std::unique_ptr<std::istream> mp::FileOps::open_read(const fs::path& path,
     return std::make_unique<std::ifstream>(path, mode);
 }
 
+bool mp::FileOps::clone_file(const fs::path& src, const fs::path& dist) const
+{
+#if defined(MULTIPASS_PLATFORM_LINUX)
+    const auto src_fd = ::open(src.c_str(), O_RDONLY | O_CLOEXEC);
+    if (src_fd == -1)
+        return false;
+
+    struct stat src_stat;
+    auto cloned = false;
+    if (::fstat(src_fd, &src_stat) == 0)
+    {
+        const auto dist_fd =
+            ::open(dist.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, src_stat.st_mode & 07777);
+        if (dist_fd != -1)
+        {
+            cloned = ::ioctl(dist_fd, FICLONE, src_fd) == 0;
+            ::close(dist_fd);
+
+            if (!cloned)
+                ::unlink(dist.c_str());
+        }
+    }
+
+    ::close(src_fd);
+    return cloned;
+#elif defined(MULTIPASS_PLATFORM_APPLE)
+    return ::clonefile(src.c_str(), dist.c_str(), 0) == 0;
+#else
+    return false;
+#endif
+}
+
 void mp::FileOps::copy(const fs::path& src,
                        const fs::path& dist,
                        fs::copy_options copy_options) const
 {
+    if (can_clone_file(src, dist, copy_options) && clone_file(src, dist))
+    {
+        mpl::trace(log_category, "Cloned {} into {}", src, dist);
+        return;
+    }
+
     fs::copy(src, dist, copy_options);
 }
 
@@ -381,6 +464,13 @@ void mp::FileOps::copy(const fs::path& src,
                        fs::copy_options copy_options,
                        std::error_code& ec) const
 {
+    if (can_clone_file(src, dist, copy_options) && clone_file(src, dist))
+    {
+        mpl::trace(log_category, "Cloned {} into {}", src, dist);
+        ec.clear();
+        return;
+    }
+
     fs::copy(src, dist, copy_options, ec);
 }
 
@@ -451,6 +541,11 @@ fs::file_status mp::FileOps::symlink_status(const fs::path& path, std::error_cod
     return fs::symlink_status(path, err);
 }
 
+fs::file_time_type mp::FileOps::last_write_time(const fs::path& path, std::error_code& err) const
+{
+    return fs::last_write_time(path, err);
+}
+
 std::unique_ptr<mp::RecursiveDirIterator>
 mp::FileOps::recursive_dir_iterator(const fs::path& path, std::error_code& err) const
 {
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <multipass/thread_pool.h>
+#include <multipass/top_catch_all.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace mpu = multipass::utils;
+
+namespace
+{
+constexpr auto category = "thread pool";
+
+// Shared between the caller of run_in_parallel and the helper tasks it submits. Helpers may only
+// start after the caller returned, so they own it too.
+struct ParallelRun
+{
+    ParallelRun(std::size_t count, const std::function<void(std::size_t)>& op)
+        : count{count}, op{op}, errors(count)
+    {
+    }
+
+    void work()
+    {
+        // Claiming an index below count means the caller is still waiting, so op is alive
+        for (auto i = next++; i < count; i = next++)
+        {
+            try
+            {
+                op(i);
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+
+            if (++done == count)
+            {
+                std::lock_guard lock{mutex};
+                cv.notify_all();
+            }
+        }
+    }
+
+    void wait()
+    {
+        std::unique_lock lock{mutex};
+        cv.wait(lock, [this] { return done == count; });
+    }
+
+    const std::size_t count;
+    const std::function<void(std::size_t)>& op;
+    std::vector<std::exception_ptr> errors;
+    std::atomic_size_t next{0};
+    std::atomic_size_t done{0};
+    std::mutex mutex;
+    std::condition_variable cv;
+};
+} // namespace
+
+mpu::ThreadPool::ThreadPool(std::size_t num_threads)
+{
+    workers.reserve(num_threads);
+    for (std::size_t i = 0; i < num_threads; ++i)
+        workers.emplace_back(&ThreadPool::main, this);
+}
+
+mpu::ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock{mutex};
+        stopping = true;
+        tasks.clear();
+    }
+
+    cv.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+void mpu::ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard lock{mutex};
+        tasks.push_back(std::move(task));
+    }
+
+    cv.notify_one();
+}
+
+std::size_t mpu::ThreadPool::size() const
+{
+    return workers.size();
+}
+
+void mpu::ThreadPool::main()
+{
+    for (;;)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock lock{mutex};
+            cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (stopping)
+                return;
+
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+
+        top_catch_all(category, task);
+    }
+}
+
+mpu::ThreadPool& mpu::shared_thread_pool()
+{
+    // Mostly network and process I/O runs here, so allow a few threads even on small machines.
+    // Never destroyed, so that exiting neither waits for nor races with tasks still running.
+    static auto* pool = new ThreadPool{std::clamp(std::thread::hardware_concurrency(), 4u, 16u)};
+    return *pool;
+}
+
+void mpu::detail::run_in_parallel(std::size_t count,
+                                  const std::function<void(std::size_t)>& op,
+                                  std::size_t max_concurrency)
+{
+    if (count == 0)
+        return;
+
+    auto& pool = shared_thread_pool();
+    auto run = std::make_shared<ParallelRun>(count, op);
+
+    const auto concurrency =
+        std::max<std::size_t>(std::min({count, max_concurrency, pool.size() + 1}), 1);
+    for (std::size_t i = 1; i < concurrency; ++i)
+        pool.submit([run] { run->work(); });
+
+    run->work();
+    run->wait();
+
+    for (const auto& error : run->errors)
+        if (error)
+            std::rethrow_exception(error);
+}
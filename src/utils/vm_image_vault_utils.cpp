@@ -26,12 +26,14 @@
 #include <fmt/std.h>
 #include <openssl/evp.h>
 
+#include <memory>
 #include <stdexcept>
 
 namespace mp = multipass;
 
 namespace
 {
+constexpr std::size_t hash_buffer_size = 1u << 20;
 
 const EVP_MD* to_evp_md(mp::ImageVaultUtils::EHashAlgorithm algo)
 {
@@ -80,16 +82,17 @@ std::string mp::ImageVaultUtils::compute_hash(std::istream& stream, EHashAlgorit
     if (!ctx || EVP_DigestInit_ex(ctx.get(), to_evp_md(algo), nullptr) != 1)
         throw std::runtime_error("Failed to initialize hash context");
 
-    constexpr std::size_t buf_size = 8192;
-    char buf[buf_size] = {0};
+    // Images are hashed in large chunks, to keep the digest's vectorized code paths busy and to let
+    // file streams read straight into the buffer instead of going through their own small one
+    const std::unique_ptr<char[]> buf{new char[hash_buffer_size]};
     do
     {
-        stream.read(buf, buf_size);
+        stream.read(buf.get(), hash_buffer_size);
         if (stream.bad())
             throw std::runtime_error("Failed to read data from device to hash");
         if (auto count = stream.gcount(); count > 0)
         {
-            if (EVP_DigestUpdate(ctx.get(), buf, static_cast<size_t>(count)) != 1)
+            if (EVP_DigestUpdate(ctx.get(), buf.get(), static_cast<size_t>(count)) != 1)
                 throw std::runtime_error("Failed to update hash");
         }
 
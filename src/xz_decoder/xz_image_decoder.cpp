@@ -20,13 +20,18 @@
 
 #include <fmt/format.h>
 
+#include <array>
 #include <fstream>
+#include <future>
 #include <vector>
 
 namespace mp = multipass;
 
 namespace
 {
+constexpr auto read_chunk_size = 1u << 20;
+constexpr auto write_chunk_size = 4u << 20;
+
 bool verify_decode(const xz_ret& ret)
 {
     switch (ret)
@@ -74,21 +79,36 @@ void mp::XzImageDecoder::decode_to(const std::filesystem::path& xz_file_path,
         throw std::runtime_error{
             fmt::format("failed to open {} for writing", decoded_image_path.string())};
 
+    // Decompressing a cloud image produces several GiB of output, so the decoded data is written
+    // from one buffer on a separate thread while the decoder fills the other one.
+    std::vector<char> read_data(read_chunk_size);
+    std::array<std::vector<char>, 2> write_data{std::vector<char>(write_chunk_size),
+                                                std::vector<char>(write_chunk_size)};
+    auto current = 0u;
+    std::future<void> pending_write;
+
+    auto flush = [&](size_t size) {
+        if (pending_write.valid())
+            pending_write.get();
+
+        const auto data = write_data[current].data();
+        pending_write = std::async(std::launch::async, [&, data, size] {
+            if (!decoded_file.write(data, size))
+                throw std::runtime_error{
+                    fmt::format("failed to write to {}", decoded_image_path.string())};
+        });
+        current ^= 1u;
+    };
+
     struct xz_buf decode_buf
     {
     };
-    const auto max_size = 65536u;
-
-    std::vector<char> read_data, write_data;
-    read_data.reserve(max_size);
-    write_data.reserve(max_size);
-
     decode_buf.in = reinterpret_cast<unsigned char*>(read_data.data());
     decode_buf.in_pos = 0;
     decode_buf.in_size = 0;
-    decode_buf.out = reinterpret_cast<unsigned char*>(write_data.data());
+    decode_buf.out = reinterpret_cast<unsigned char*>(write_data[current].data());
     decode_buf.out_pos = 0;
-    decode_buf.out_size = max_size;
+    decode_buf.out_size = write_chunk_size;
 
     const auto file_size = std::filesystem::file_size(xz_file_path);
     std::int64_t total_bytes_extracted{0};
@@ -98,7 +118,7 @@ void mp::XzImageDecoder::decode_to(const std::filesystem::path& xz_file_path,
     {
         if (decode_buf.in_pos == decode_buf.in_size)
         {
-            xz_file.read(read_data.data(), max_size);
+            xz_file.read(read_data.data(), read_chunk_size);
             decode_buf.in_size = xz_file.gcount();
             decode_buf.in_pos = 0;
             total_bytes_extracted += decode_buf.in_size;
@@ -110,13 +130,15 @@ void mp::XzImageDecoder::decode_to(const std::filesystem::path& xz_file_path,
 
         if (!verify_decode(xz_dec_run(xz_decoder.get(), &decode_buf)))
         {
-            decoded_file.write(write_data.data(), decode_buf.out_pos);
+            flush(decode_buf.out_pos);
+            pending_write.get();
             return;
         }
 
-        if (decode_buf.out_pos == max_size)
+        if (decode_buf.out_pos == write_chunk_size)
         {
-            decoded_file.write(write_data.data(), decode_buf.out_pos);
+            flush(decode_buf.out_pos);
+            decode_buf.out = reinterpret_cast<unsigned char*>(write_data[current].data());
             decode_buf.out_pos = 0;
         }
     }
@@ -73,6 +73,12 @@ add_c_mocks(
   sftp_open
   sftp_write
   sftp_read
+  sftp_seek64
+  sftp_aio_begin_read
+  sftp_aio_wait_read
+  sftp_aio_begin_write
+  sftp_aio_wait_write
+  sftp_aio_free
   sftp_free
   sftp_get_error
   sftp_close
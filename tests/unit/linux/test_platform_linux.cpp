@@ -43,6 +43,7 @@
 #include <QFile>
 #include <QString>
 
+#include <map>
 #include <stdexcept>
 #include <tests/unit/mock_platform.h>
 #include <tests/unit/stub_availability_zone_manager.h>
@@ -102,9 +103,43 @@ TEST_F(PlatformLinux, testNoExtraClientSettings)
     EXPECT_THAT(MP_PLATFORM.extra_client_settings(), IsEmpty());
 }
 
-TEST_F(PlatformLinux, testNoExtraDaemonSettings)
+TEST_F(PlatformLinux, testExtraDaemonSettingsSelectNativeMountTransport)
 {
-    EXPECT_THAT(MP_PLATFORM.extra_daemon_settings(), IsEmpty());
+    const auto settings = MP_PLATFORM.extra_daemon_settings();
+
+    std::map<QString, QString> defaults;
+    for (const auto& spec : settings)
+        defaults[spec->get_key()] = spec->get_default();
+
+    EXPECT_THAT(defaults,
+                UnorderedElementsAre(Pair(mp::native_mount_transport_key, "9p"),
+                                     Pair(mp::virtiofs_cache_key, "auto")));
+}
+
+TEST_F(PlatformLinux, testInterpretationOfNativeMountSettings)
+{
+    auto [mock_file_ops, guard] = mpt::MockFileOps::inject();
+    EXPECT_CALL(*mock_file_ops, exists(A<const QFileInfo&>())).WillRepeatedly(Return(true));
+
+    EXPECT_EQ(mp::platform::interpret_setting(mp::native_mount_transport_key, "VirtioFS"),
+              "virtiofs");
+    EXPECT_EQ(mp::platform::interpret_setting(mp::native_mount_transport_key, "9p"), "9p");
+    EXPECT_EQ(mp::platform::interpret_setting(mp::virtiofs_cache_key, "never"), "never");
+
+    for (const auto* key : {mp::native_mount_transport_key, mp::virtiofs_cache_key})
+        EXPECT_THROW(mp::platform::interpret_setting(key, "sshfs"), mp::InvalidSettingException);
+}
+
+TEST_F(PlatformLinux, testVirtiofsTransportNeedsVirtiofsd)
+{
+    auto [mock_file_ops, guard] = mpt::MockFileOps::inject();
+    EXPECT_CALL(*mock_file_ops, exists(A<const QFileInfo&>())).WillOnce(Return(false));
+
+    MP_EXPECT_THROW_THAT(mp::platform::interpret_setting(mp::native_mount_transport_key,
+                                                         mp::native_mount_transport_virtiofs),
+                         mp::InvalidSettingException,
+                         mpt::match_what(HasSubstr("virtiofsd is not installed")));
+    EXPECT_EQ(mp::platform::interpret_setting(mp::native_mount_transport_key, "9p"), "9p");
 }
 
 TEST_F(PlatformLinux, testEmptySyncWintermProfiles)
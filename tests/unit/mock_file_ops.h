@@ -87,8 +87,10 @@ public:
                 (const fs::path&, int, int),
                 (const, override));
     MOCK_METHOD(int, read, (int, void*, size_t), (const, override));
+    MOCK_METHOD(int, pread, (int, void*, size_t, off_t), (const, override));
     MOCK_METHOD(int, write, (int, const void*, size_t), (const, override));
     MOCK_METHOD(off_t, lseek, (int, off_t, int), (const, override));
+    MOCK_METHOD(int, fstat, (int, struct stat*), (const, override));
 
     // Mock std methods
     MOCK_METHOD(void,
@@ -118,6 +120,7 @@ public:
                  fs::copy_options,
                  std::error_code&),
                 (const, override));
+    MOCK_METHOD(bool, clone_file, (const fs::path& src, const fs::path& dist), (const, override));
     MOCK_METHOD(void, rename, (const fs::path& old_p, const fs::path& new_p), (override, const));
     MOCK_METHOD(bool, exists, (const fs::path& path), (override, const));
     MOCK_METHOD(bool,
@@ -158,6 +161,10 @@ public:
                 symlink_status,
                 (const fs::path& path, std::error_code& err),
                 (override, const));
+    MOCK_METHOD(fs::file_time_type,
+                last_write_time,
+                (const fs::path& path, std::error_code& err),
+                (override, const));
     MOCK_METHOD(std::unique_ptr<multipass::RecursiveDirIterator>,
                 recursive_dir_iterator,
                 (const fs::path& path, std::error_code& err),
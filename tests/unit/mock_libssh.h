@@ -191,6 +191,21 @@ public:
                 sftp_write,
                 (sftp_file file, const void* buf, size_t count),
                 (const, override));
+    MOCK_METHOD(int, sftp_seek64, (sftp_file file, uint64_t new_offset), (const, override));
+    MOCK_METHOD(ssize_t,
+                sftp_aio_begin_read,
+                (sftp_file file, size_t len, sftp_aio* aio),
+                (const, override));
+    MOCK_METHOD(ssize_t,
+                sftp_aio_wait_read,
+                (sftp_aio* aio, void* buf, size_t buf_size),
+                (const, override));
+    MOCK_METHOD(ssize_t,
+                sftp_aio_begin_write,
+                (sftp_file file, const void* buf, size_t len, sftp_aio* aio),
+                (const, override));
+    MOCK_METHOD(ssize_t, sftp_aio_wait_write, (sftp_aio* aio), (const, override));
+    MOCK_METHOD(void, sftp_aio_free, (sftp_aio aio), (const, override));
     MOCK_METHOD(int,
                 sftp_chmod,
                 (sftp_session sftp, const char* file, mode_t mode),
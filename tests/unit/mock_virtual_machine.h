@@ -71,6 +71,8 @@ struct MockVirtualMachineT : public T
         ON_CALL(*this, ssh_username).WillByDefault(Return("ubuntu"));
         ON_CALL(*this, management_ipv4).WillByDefault(Return(IPAddress{"0.0.0.0"}));
         ON_CALL(*this, get_all_ipv4).WillByDefault(Return(std::vector{IPAddress{"192.168.2.123"}}));
+        ON_CALL(*this, all_ipv4_from)
+            .WillByDefault(Return(std::vector{IPAddress{"192.168.2.123"}}));
         ON_CALL(*this, instance_directory).WillByDefault(Return(this->tmp_dir->path()));
         ON_CALL(*this, ssh_exec_process).WillByDefault(std::make_unique<NiceMock<MockSSHProcess>>);
         ON_CALL(*this, new_ssh_session).WillByDefault(std::make_unique<NiceMock<MockSSHSession>>);
@@ -86,6 +88,7 @@ struct MockVirtualMachineT : public T
     MOCK_METHOD(std::string, ssh_username, (), (override));
     MOCK_METHOD(std::optional<IPAddress>, management_ipv4, (), (override));
     MOCK_METHOD(std::vector<IPAddress>, get_all_ipv4, (), (override));
+    MOCK_METHOD(std::vector<IPAddress>, all_ipv4_from, (const std::string&), (override));
     MOCK_METHOD(std::string, ssh_exec, (const std::string& cmd, bool whisper), (override));
     MOCK_METHOD(std::unique_ptr<SSHProcess>,
                 ssh_exec_process,
@@ -119,6 +122,7 @@ struct MockVirtualMachineT : public T
     MOCK_METHOD(std::shared_ptr<const Snapshot>, get_snapshot, (int index), (const, override));
     MOCK_METHOD(std::shared_ptr<Snapshot>, get_snapshot, (const std::string&), (override));
     MOCK_METHOD(std::shared_ptr<Snapshot>, get_snapshot, (int index), (override));
+    MOCK_METHOD(bool, supports_live_snapshots, (), (const, override));
     MOCK_METHOD(std::shared_ptr<const Snapshot>,
                 take_snapshot,
                 (const VMSpecs&, const std::string&, const std::string&),
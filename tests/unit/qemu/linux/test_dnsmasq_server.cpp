@@ -31,6 +31,7 @@
 #include <multipass/logging/logger.h>
 
 #include <QDir>
+#include <QFile>
 
 #include <memory>
 #include <stdexcept>
@@ -243,6 +244,39 @@ TEST_F(DNSMasqServer, getIpForIgnoresNonIpv4AndMalformedLines)
     EXPECT_EQ(ip.value(), live_ip);
 }
 
+TEST_F(DNSMasqServer, getIpForSkipsExpiredLeases)
+{
+    const mp::IPAddress expired_ip{"192.168.64.80"};
+    mpt::make_file_with_content(QDir{data_dir.path()}.filePath("dnsmasq.leases"),
+                                fmt::format("1 {} {} vm-expired *\n0 {} {} vm-live *\n",
+                                            hw_addr,
+                                            expired_ip.as_string(),
+                                            hw_addr,
+                                            expected_ip.as_string()));
+
+    auto dns = make_default_dnsmasq_server();
+
+    auto ip = dns.get_ip_for(hw_addr);
+    ASSERT_TRUE(ip);
+    EXPECT_EQ(ip.value(), expected_ip);
+}
+
+TEST_F(DNSMasqServer, getIpForFollowsLeasesFileChanges)
+{
+    auto dns = make_default_dnsmasq_server();
+    EXPECT_FALSE(dns.get_ip_for(hw_addr));
+
+    make_lease_entry();
+    EXPECT_EQ(dns.get_ip_for(hw_addr), expected_ip);
+
+    const auto leases_path = QDir{data_dir.path()}.filePath("dnsmasq.leases");
+    const mp::IPAddress new_ip{"192.168.64.90"};
+    ASSERT_TRUE(QFile::remove(leases_path));
+    mpt::make_file_with_content(leases_path,
+                                fmt::format("0 {} {} renamed *\n", hw_addr, new_ip.as_string()));
+    EXPECT_EQ(dns.get_ip_for(hw_addr), new_ip);
+}
+
 TEST_F(DNSMasqServer, releaseMacReleasesIp)
 {
     const QString dhcp_release_called{QDir{data_dir.path()}.filePath("dhcp_release_called")};
@@ -48,6 +48,49 @@ struct FirewallConfig : public Test
     const mp::Subnet subnet{"192.168.2.0/24"};
 
     mpt::MockLogger::Scope logger_scope = mpt::MockLogger::inject();
+
+    static bool is_restore(mpt::MockProcess* process)
+    {
+        return process->program().endsWith("-restore");
+    }
+
+    // Rules are fed to iptables-restore through its standard input, so the process is waited for
+    // rather than executed; record what it is given
+    static void expect_restore(mpt::MockProcess* process,
+                               QByteArray& transaction,
+                               const mp::ProcessState& exit_state = {0, std::nullopt})
+    {
+        EXPECT_CALL(*process, write(_)).WillOnce([&transaction](const QByteArray& data) {
+            transaction = data;
+            return data.size();
+        });
+        EXPECT_CALL(*process, wait_for_finished(_)).WillOnce(Return(true));
+        ON_CALL(*process, process_state()).WillByDefault(Return(exit_state));
+    }
+
+    // Turn a transaction into what iptables-save would list once it is applied on a clean slate
+    static QByteArray saved_after(const QByteArray& transaction)
+    {
+        QByteArray saved;
+        QList<QByteArray> inserted, appended;
+        for (const auto& line : transaction.split('\n'))
+        {
+            if (line.startsWith("-I "))
+                inserted.prepend("-A " + line.mid(3));
+            else if (line.startsWith("-A "))
+                appended.append(line);
+            else if (line == "COMMIT")
+            {
+                saved += (inserted + appended).join('\n') + "\nCOMMIT\n";
+                inserted.clear();
+                appended.clear();
+            }
+            else
+                saved += line + '\n';
+        }
+
+        return saved;
+    }
 };
 
 struct FirewallToUseTestSuite : FirewallConfig,
@@ -64,14 +107,19 @@ struct KernelCheckTestSuite : FirewallConfig,
 TEST_F(FirewallConfig, iptablesNftErrorLogsWarningUsesIptablesLegacyByDefault)
 {
     const QString error_msg{"Cannot find iptables-nft"};
-    mpt::MockProcessFactory::Callback firewall_callback = [&error_msg](mpt::MockProcess* process) {
-        if (process->program() == "iptables-nft")
+    QByteArray transaction;
+    mpt::MockProcessFactory::Callback firewall_callback = [&](mpt::MockProcess* process) {
+        if (process->program() == "iptables-nft-save")
         {
             mp::ProcessState exit_state{
                 1,
                 mp::ProcessState::Error{QProcess::FailedToStart, error_msg}};
             EXPECT_CALL(*process, execute(_)).WillOnce(Return(exit_state));
         }
+        else if (process->program() == "iptables-legacy-restore")
+        {
+            expect_restore(process, transaction);
+        }
     };
 
     auto factory = mpt::MockProcessFactory::Inject();
@@ -86,13 +134,10 @@ TEST_F(FirewallConfig, iptablesNftErrorLogsWarningUsesIptablesLegacyByDefault)
 
 TEST_F(FirewallConfig, firewallVerifyNoErrorDoesNotThrow)
 {
-    mpt::MockProcessFactory::Callback firewall_callback = [this](mpt::MockProcess* process) {
-        if (process->arguments().contains(goodbr0))
-        {
-            mp::ProcessState exit_state;
-            exit_state.exit_code = 0;
-            EXPECT_CALL(*process, execute(_)).WillOnce(Return(exit_state));
-        }
+    QByteArray transaction;
+    mpt::MockProcessFactory::Callback firewall_callback = [&](mpt::MockProcess* process) {
+        if (is_restore(process))
+            expect_restore(process, transaction);
     };
 
     auto factory = mpt::MockProcessFactory::Inject();
@@ -101,18 +146,18 @@ TEST_F(FirewallConfig, firewallVerifyNoErrorDoesNotThrow)
     mp::BasicFirewallConfig firewall_config{goodbr0, subnet};
 
     EXPECT_NO_THROW(firewall_config.verify_firewall_rules());
+    EXPECT_TRUE(transaction.contains(goodbr0.toUtf8()));
 }
 
 TEST_F(FirewallConfig, firewallErrorThrowsOnVerify)
 {
     const QByteArray msg{"Evil bridge detected!"};
+    QByteArray transaction;
 
-    mpt::MockProcessFactory::Callback firewall_callback = [this, &msg](mpt::MockProcess* process) {
-        if (process->arguments().contains(evilbr0))
+    mpt::MockProcessFactory::Callback firewall_callback = [&](mpt::MockProcess* process) {
+        if (is_restore(process))
         {
-            mp::ProcessState exit_state;
-            exit_state.exit_code = 1;
-            EXPECT_CALL(*process, execute(_)).WillOnce(Return(exit_state));
+            expect_restore(process, transaction, {1, std::nullopt});
             EXPECT_CALL(*process, read_all_standard_error()).WillOnce(Return(msg));
         }
     };
@@ -127,6 +172,139 @@ TEST_F(FirewallConfig, firewallErrorThrowsOnVerify)
                          mpt::match_what(HasSubstr(msg.data())));
 }
 
+TEST_F(FirewallConfig, setsAllRulesInOneTransaction)
+{
+    QByteArray transaction;
+    mpt::MockProcessFactory::Callback firewall_callback = [&](mpt::MockProcess* process) {
+        if (is_restore(process))
+            expect_restore(process, transaction);
+    };
+
+    auto factory = mpt::MockProcessFactory::Inject();
+    factory->register_callback(firewall_callback);
+
+    mp::BasicFirewallConfig firewall_config{goodbr0, subnet};
+
+    const auto processes = factory->process_list();
+    EXPECT_EQ(std::count_if(processes.cbegin(),
+                            processes.cend(),
+                            [](const auto& info) { return info.command.endsWith("-restore"); }),
+              1);
+
+    const auto lines = transaction.split('\n');
+    EXPECT_EQ(lines.count("*filter"), 1);
+    EXPECT_EQ(lines.count("*nat"), 1);
+    EXPECT_EQ(lines.count("*mangle"), 1);
+    EXPECT_EQ(lines.count("COMMIT"), 3);
+    EXPECT_EQ(std::count_if(lines.cbegin(),
+                            lines.cend(),
+                            [](const auto& line) { return line.startsWith("-I "); }),
+              15);
+    EXPECT_EQ(std::count_if(lines.cbegin(),
+                            lines.cend(),
+                            [](const auto& line) { return line.startsWith("-A FORWARD "); }),
+              2);
+}
+
+TEST_F(FirewallConfig, leavesRulesAloneWhenAlreadyInPlace)
+{
+    QByteArray transaction;
+    QByteArray saved;
+    mpt::MockProcessFactory::Callback firewall_callback = [&](mpt::MockProcess* process) {
+        if (is_restore(process))
+            expect_restore(process, transaction);
+        else if (process->program().endsWith("-save"))
+            EXPECT_CALL(*process, read_all_standard_output()).WillOnce(Return(saved));
+    };
+
+    auto factory = mpt::MockProcessFactory::Inject();
+    factory->register_callback(firewall_callback);
+
+    {
+        mp::BasicFirewallConfig firewall_config{goodbr0, subnet};
+    }
+
+    saved = saved_after(transaction);
+    transaction.clear();
+
+    mp::BasicFirewallConfig firewall_config{goodbr0, subnet};
+    EXPECT_TRUE(transaction.isEmpty());
+}
+
+TEST_F(FirewallConfig, replacesRulesOnlyInChainsThatDiffer)
+{
+    const QByteArray stale_rule{
+        fmt::format("-A FORWARD -i {} -m comment --comment \"generated for Multipass network {}\" "
+                    "-j ACCEPT",
+                    goodbr0,
+                    goodbr0)
+            .data()};
+    QByteArray transaction;
+    QByteArray saved;
+    mpt::MockProcessFactory::Callback firewall_callback = [&](mpt::MockProcess* process) {
+        if (is_restore(process))
+            expect_restore(process, transaction);
+        else if (process->program().endsWith("-save"))
+            EXPECT_CALL(*process, read_all_standard_output()).WillOnce(Return(saved));
+    };
+
+    auto factory = mpt::MockProcessFactory::Inject();
+    factory->register_callback(firewall_callback);
+
+    {
+        mp::BasicFirewallConfig firewall_config{goodbr0, subnet};
+    }
+
+    saved = saved_after(transaction).replace("*filter\n", "*filter\n" + stale_rule + '\n');
+    transaction.clear();
+
+    mp::BasicFirewallConfig firewall_config{goodbr0, subnet};
+
+    EXPECT_TRUE(transaction.contains("-D " + stale_rule.mid(3)));
+    EXPECT_TRUE(transaction.contains("-I FORWARD "));
+    EXPECT_FALSE(transaction.contains("-I INPUT "));
+    EXPECT_FALSE(transaction.contains("*nat"));
+    EXPECT_FALSE(transaction.contains("*mangle"));
+}
+
+TEST_F(FirewallConfig, logsTablesSetBeforeTransactionFailed)
+{
+    QByteArray transaction;
+    QByteArray teardown;
+    auto restores = 0;
+    mpt::MockProcessFactory::Callback firewall_callback = [&](mpt::MockProcess* process) {
+        if (is_restore(process))
+        {
+            if (restores++ == 0)
+                expect_restore(process, transaction, {1, std::nullopt});
+            else
+                expect_restore(process, teardown);
+        }
+        else if (process->program().endsWith("-save"))
+        {
+            // iptables-legacy commits the filter table before failing on the next one
+            EXPECT_CALL(*process, read_all_standard_output()).WillOnce([&transaction] {
+                const auto saved = saved_after(transaction);
+                return transaction.isEmpty() ? QByteArray{} : saved.left(saved.indexOf("*nat"));
+            });
+        }
+    };
+
+    auto factory = mpt::MockProcessFactory::Inject();
+    factory->register_callback(firewall_callback);
+
+    logger_scope.mock_logger->expect_log(mpl::Level::warning,
+                                         "only partly set, in tables: filter");
+
+    {
+        mp::BasicFirewallConfig firewall_config{goodbr0, subnet};
+        EXPECT_THROW(firewall_config.verify_firewall_rules(), std::runtime_error);
+    }
+
+    EXPECT_TRUE(teardown.contains("*filter"));
+    EXPECT_FALSE(teardown.contains("*nat"));
+}
+
 TEST_F(FirewallConfig, dtorDeletesKnownRules)
 {
     const QByteArray base_rule{
@@ -136,21 +314,15 @@ TEST_F(FirewallConfig, dtorDeletesKnownRules)
                     subnet,
                     goodbr0)
             .data()};
-    const QByteArray full_rule{"-A " + base_rule};
-    bool delete_called{false};
+    const QByteArray saved{"*nat\n-A " + base_rule + "\nCOMMIT\n"};
+    QByteArray transaction;
 
-    mpt::MockProcessFactory::Callback firewall_callback =
-        [&base_rule, &full_rule, &delete_called](mpt::MockProcess* process) {
-            if (process->arguments().contains("--list-rules"))
-            {
-                EXPECT_CALL(*process, read_all_standard_output()).WillRepeatedly(Return(full_rule));
-            }
-            else if (process->program() == "sh" && process->arguments().at(1).contains("--delete"))
-            {
-                delete_called = true;
-                EXPECT_TRUE(process->arguments().at(1).contains(base_rule));
-            }
-        };
+    mpt::MockProcessFactory::Callback firewall_callback = [&](mpt::MockProcess* process) {
+        if (process->program().endsWith("-save"))
+            EXPECT_CALL(*process, read_all_standard_output()).WillRepeatedly(Return(saved));
+        else if (is_restore(process))
+            expect_restore(process, transaction);
+    };
 
     auto factory = mpt::MockProcessFactory::Inject();
     factory->register_callback(firewall_callback);
@@ -159,35 +331,29 @@ TEST_F(FirewallConfig, dtorDeletesKnownRules)
         mp::BasicFirewallConfig firewall_config{goodbr0, subnet};
     }
 
-    EXPECT_TRUE(delete_called);
+    EXPECT_TRUE(transaction.contains("*nat\n-D " + base_rule + '\n'));
+    EXPECT_FALSE(transaction.contains("-I "));
 }
 
-TEST_F(FirewallConfig, dtorDeleteErrorLogsErrorAndContinues)
+TEST_F(FirewallConfig, dtorDeleteErrorLogsError)
 {
-    const QByteArray base_rule{
-        fmt::format("POSTROUTING -s {} ! -d {} -m comment --comment \"generated for "
-                    "Multipass network {}\" -j MASQUERADE",
-                    subnet,
-                    subnet,
+    const QByteArray saved{
+        fmt::format("*filter\n-A FORWARD -o {} -j REJECT --reject-with icmp-port-unreachable\n"
+                    "COMMIT\n",
                     goodbr0)
             .data()};
-    const QByteArray full_rule{"-A " + base_rule};
     const QByteArray msg{"Bad stuff happened"};
+    QByteArray transaction;
 
     mpt::MockProcessFactory::Callback firewall_callback = [&](mpt::MockProcess* process) {
-        if (process->arguments().contains("--list-rules"))
+        if (process->program().endsWith("-save"))
         {
-            EXPECT_CALL(*process, read_all_standard_output()).WillRepeatedly(Return(full_rule));
+            EXPECT_CALL(*process, read_all_standard_output()).WillRepeatedly(Return(saved));
         }
-        else if (process->program() == "sh" && process->arguments().at(1).contains("--delete"))
+        else if (is_restore(process))
         {
-            if (process->arguments().at(1).contains(base_rule))
-            {
-                mp::ProcessState exit_state;
-                exit_state.exit_code = 1;
-                EXPECT_CALL(*process, execute(_)).WillRepeatedly(Return(exit_state));
-                EXPECT_CALL(*process, read_all_standard_error()).WillOnce(Return(msg));
-            }
+            expect_restore(process, transaction, {1, std::nullopt});
+            EXPECT_CALL(*process, read_all_standard_error()).WillOnce(Return(msg));
         }
     };
 
@@ -195,26 +361,34 @@ TEST_F(FirewallConfig, dtorDeleteErrorLogsErrorAndContinues)
     factory->register_callback(firewall_callback);
 
     logger_scope.mock_logger->screen_logs(mpl::Level::error);
-    logger_scope.mock_logger->expect_log(mpl::Level::error, msg.toStdString(), AnyNumber());
+    logger_scope.mock_logger->expect_log(mpl::Level::error, msg.toStdString());
 
     {
         mp::BasicFirewallConfig firewall_config{goodbr0, subnet};
     }
+
+    EXPECT_TRUE(transaction.contains("-D FORWARD -o " + goodbr0.toUtf8()));
 }
 
 TEST_P(FirewallToUseTestSuite, usesExpectedFirewall)
 {
     const auto& param = GetParam();
+    QByteArray transaction;
 
-    mpt::MockProcessFactory::Callback firewall_callback = [&param](mpt::MockProcess* process) {
-        if (process->program() == "iptables-nft" && process->arguments().contains("--list-rules"))
+    mpt::MockProcessFactory::Callback firewall_callback = [&](mpt::MockProcess* process) {
+        if (process->program() == "iptables-nft-save")
+        {
+            EXPECT_CALL(*process, read_all_standard_output())
+                .WillRepeatedly(Return(std::get<1>(param)));
+        }
+        else if (process->program() == "iptables-legacy-save")
         {
-            EXPECT_CALL(*process, read_all_standard_output()).WillOnce(Return(std::get<1>(param)));
+            EXPECT_CALL(*process, read_all_standard_output())
+                .WillRepeatedly(Return(std::get<2>(param)));
         }
-        else if (process->program() == "iptables-legacy" &&
-                 process->arguments().contains("--list-rules"))
+        else if (is_restore(process))
         {
-            EXPECT_CALL(*process, read_all_standard_output()).WillOnce(Return(std::get<2>(param)));
+            expect_restore(process, transaction);
         }
     };
 
@@ -227,30 +401,37 @@ TEST_P(FirewallToUseTestSuite, usesExpectedFirewall)
     mp::BasicFirewallConfig firewall_config{goodbr0, subnet};
 }
 
-INSTANTIATE_TEST_SUITE_P(FirewallConfig,
-                         FirewallToUseTestSuite,
-                         Values(std::make_tuple("iptables-legacy", QByteArray(), "-N FOO"),
-                                std::make_tuple("iptables-nft", "-N FOO", QByteArray()),
-                                std::make_tuple("iptables-nft", QByteArray(), QByteArray()),
-                                std::make_tuple("iptables-nft", "-N FOO", "-N FOO")));
+INSTANTIATE_TEST_SUITE_P(
+    FirewallConfig,
+    FirewallToUseTestSuite,
+    Values(std::make_tuple("iptables-legacy", QByteArray(), "*filter\n:FOO - [0:0]\nCOMMIT\n"),
+           std::make_tuple("iptables-nft", "*filter\n:FOO - [0:0]\nCOMMIT\n", QByteArray()),
+           std::make_tuple("iptables-nft", QByteArray(), QByteArray()),
+           std::make_tuple("iptables-nft", "*nat\n-A FOO -j ACCEPT\nCOMMIT\n", "*nat\n-A FOO\n"),
+           std::make_tuple("iptables-legacy",
+                           "*filter\n:INPUT ACCEPT [0:0]\nCOMMIT\n",
+                           "*filter\n-A INPUT -j ACCEPT\nCOMMIT\n")));
 
 TEST_P(KernelCheckTestSuite, usesIptablesAndLogsWithBadKernelInfo)
 {
     auto [kernel, msg] = GetParam();
     bool nftables_called{false};
+    QByteArray transaction;
 
-    mpt::MockProcessFactory::Callback firewall_callback =
-        [&nftables_called](mpt::MockProcess* process) {
-            if (process->program() == "iptables-legacy" &&
-                process->arguments().contains("--list-rules"))
-            {
-                EXPECT_CALL(*process, read_all_standard_output()).WillOnce(Return(QByteArray()));
-            }
-            else if (process->program() == "iptables-nft")
-            {
-                nftables_called = true;
-            }
-        };
+    mpt::MockProcessFactory::Callback firewall_callback = [&](mpt::MockProcess* process) {
+        if (process->program() == "iptables-legacy-save")
+        {
+            EXPECT_CALL(*process, read_all_standard_output()).WillOnce(Return(QByteArray()));
+        }
+        else if (process->program() == "iptables-legacy-restore")
+        {
+            expect_restore(process, transaction);
+        }
+        else if (process->program().startsWith("iptables-nft"))
+        {
+            nftables_called = true;
+        }
+    };
 
     auto factory = mpt::MockProcessFactory::Inject();
     factory->register_callback(firewall_callback);
@@ -18,6 +18,7 @@
 #include "mock_qemu_platform.h"
 
 #include "tests/unit/common.h"
+#include "tests/unit/file_operations.h"
 #include "tests/unit/mock_cloud_init_file_ops.h"
 #include "tests/unit/mock_environment_helpers.h"
 #include "tests/unit/mock_logger.h"
@@ -38,6 +39,7 @@
 
 #include <src/platform/backends/qemu/qemu_virtual_machine.h>
 #include <src/platform/backends/qemu/qemu_virtual_machine_factory.h>
+#include <src/platform/backends/qemu/qemu_vm_process_spec.h>
 
 #include <multipass/auto_join_thread.h>
 #include <multipass/exceptions/ip_unavailable_exception.h>
@@ -123,6 +125,24 @@ struct QemuBackend : public mpt::TestWithMockedBinPath
             }
         };
 
+    static void reply_to_qmp(mpt::MockProcess* process, const char* reply)
+    {
+        EXPECT_CALL(*process, read_all_standard_output())
+            .WillRepeatedly(Return(QByteArray{reply} + "\r\n"));
+        emit process->ready_read_standard_output();
+    }
+
+    static void expect_suspend_kill(mpt::MockProcess* process)
+    {
+        EXPECT_CALL(*process, kill()).WillOnce([process] {
+            mp::ProcessState exit_state{
+                std::nullopt,
+                mp::ProcessState::Error{QProcess::Crashed, QStringLiteral("")}};
+            emit process->error_occurred(QProcess::Crashed, "Crashed");
+            emit process->finished(exit_state);
+        });
+    }
+
     static void handle_qemu_system(mpt::MockProcess* process)
     {
         if (process->program().contains("qemu-system"))
@@ -146,25 +166,28 @@ struct QemuBackend : public mpt::TestWithMockedBinPath
                         return true;
                     });
                 }
+                else if (execute == "migrate-set-capabilities" && json.as_object().contains("id"))
+                {
+                    reply_to_qmp(process, "{\"return\": {}, \"id\": \"suspend-capabilities\"}");
+                }
+                else if (execute == "migrate")
+                {
+                    expect_suspend_kill(process);
+                    reply_to_qmp(process,
+                                 "{\"timestamp\": {\"seconds\": 1541188919, "
+                                 "\"microseconds\": 838498}, \"event\": \"MIGRATION\", "
+                                 "\"data\": {\"status\": \"completed\"}}");
+                }
                 else if (execute == "human-monitor-command")
                 {
                     auto args = json.at("arguments");
                     auto command_line = value_to<std::string>(args.at("command-line"));
                     if (command_line == "savevm suspend")
                     {
-                        EXPECT_CALL(*process, read_all_standard_output())
-                            .WillRepeatedly(Return("{\"timestamp\": {\"seconds\": 1541188919, "
-                                                   "\"microseconds\": 838498}, \"event\": "
-                                                   "\"RESUME\"}"));
-
-                        EXPECT_CALL(*process, kill()).WillOnce([process] {
-                            mp::ProcessState exit_state{
-                                std::nullopt,
-                                mp::ProcessState::Error{QProcess::Crashed, QStringLiteral("")}};
-                            emit process->error_occurred(QProcess::Crashed, "Crashed");
-                            emit process->finished(exit_state);
-                        });
-                        emit process->ready_read_standard_output();
+                        expect_suspend_kill(process);
+                        reply_to_qmp(process,
+                                     "{\"timestamp\": {\"seconds\": 1541188919, "
+                                     "\"microseconds\": 838498}, \"event\": \"RESUME\"}");
                     }
                 }
 
@@ -278,6 +301,437 @@ TEST_F(QemuBackend, machineStartSuspendSendsMonitoringEvent)
     machine->suspend();
 }
 
+TEST_F(QemuBackend, suspendFallsBackToSavevmWhenStateCannotBeMigratedToFile)
+{
+    EXPECT_CALL(*mock_qemu_platform_factory, make_qemu_platform(_, _)).WillOnce([this](auto&&...) {
+        return std::move(mock_qemu_platform);
+    });
+
+    NiceMock<mpt::MockVMStatusMonitor> mock_monitor;
+    mp::QemuVirtualMachineFactory backend{data_dir.path(), az_manager};
+
+    process_factory->register_callback([](mpt::MockProcess* process) {
+        handle_qemu_system(process);
+        if (process->program().contains("qemu-system"))
+        {
+            EXPECT_CALL(*process, write(_)).WillRepeatedly([process](const QByteArray& data) {
+                auto json = boost::json::parse(std::string_view(data));
+                auto execute = value_to<std::string>(json.at("execute"));
+
+                if (execute == "migrate-set-capabilities")
+                {
+                    reply_to_qmp(process,
+                                 "{\"error\": {\"desc\": \"unknown capability\"}, "
+                                 "\"id\": \"suspend-capabilities\"}");
+                }
+                else if (execute == "migrate")
+                {
+                    ADD_FAILURE() << "Unexpected migration";
+                }
+                else if (execute == "human-monitor-command")
+                {
+                    expect_suspend_kill(process);
+                    reply_to_qmp(process, "{\"event\": \"STOP\"}\n{\"event\": \"RESUME\"}");
+                }
+
+                return data.size();
+            });
+        }
+    });
+
+    auto machine = backend.create_virtual_machine(default_description, key_provider, mock_monitor);
+    machine->start();
+    machine->state = mp::VirtualMachine::State::running;
+
+    logger_scope.mock_logger->screen_logs(mpl::Level::error);
+    EXPECT_CALL(mock_monitor, on_suspend());
+    machine->suspend();
+
+    EXPECT_EQ(machine->current_state(), mp::VirtualMachine::State::suspended);
+}
+
+TEST_F(QemuBackend, suspendLeavesInstanceRunningWhenMigrationFails)
+{
+    EXPECT_CALL(*mock_qemu_platform_factory, make_qemu_platform(_, _)).WillOnce([this](auto&&...) {
+        return std::move(mock_qemu_platform);
+    });
+
+    NiceMock<mpt::MockVMStatusMonitor> mock_monitor;
+    mp::QemuVirtualMachineFactory backend{data_dir.path(), az_manager};
+
+    auto migrations = 0;
+    process_factory->register_callback([&migrations](mpt::MockProcess* process) {
+        handle_qemu_system(process);
+        if (process->program().contains("qemu-system"))
+        {
+            EXPECT_CALL(*process, write(_))
+                .WillRepeatedly([process, &migrations](const QByteArray& data) {
+                    auto json = boost::json::parse(std::string_view(data));
+                    auto execute = value_to<std::string>(json.at("execute"));
+
+                    if (execute == "migrate-set-capabilities" && json.as_object().contains("id"))
+                    {
+                        reply_to_qmp(process,
+                                     "{\"return\": {}, \"id\": \"suspend-capabilities\"}");
+                    }
+                    else if (execute == "migrate" && migrations++ == 0)
+                    {
+                        reply_to_qmp(process,
+                                     "{\"event\": \"MIGRATION\", "
+                                     "\"data\": {\"status\": \"failed\"}}");
+                    }
+                    else if (execute == "migrate") // let the instance suspend on destruction
+                    {
+                        expect_suspend_kill(process);
+                        reply_to_qmp(process,
+                                     "{\"event\": \"MIGRATION\", "
+                                     "\"data\": {\"status\": \"completed\"}}");
+                    }
+
+                    return data.size();
+                });
+        }
+    });
+
+    auto machine = backend.create_virtual_machine(default_description, key_provider, mock_monitor);
+    machine->start();
+    machine->state = mp::VirtualMachine::State::running;
+
+    logger_scope.mock_logger->screen_logs(mpl::Level::error);
+    logger_scope.mock_logger->expect_log(mpl::Level::error, "Migration failed");
+    MP_EXPECT_THROW_THAT(machine->suspend(),
+                         std::runtime_error,
+                         mpt::match_what(HasSubstr("the instance was left running")));
+
+    EXPECT_EQ(machine->current_state(), mp::VirtualMachine::State::running);
+    EXPECT_EQ(migrations, 1);
+}
+
+TEST_F(QemuBackend, suspendGivesUpOnMigrationThatDoesNotFinishInTime)
+{
+    EXPECT_CALL(*mock_qemu_platform_factory, make_qemu_platform(_, _)).WillOnce([this](auto&&...) {
+        return std::move(mock_qemu_platform);
+    });
+
+    NiceMock<mpt::MockVMStatusMonitor> mock_monitor;
+    mp::QemuVirtualMachineFactory backend{data_dir.path(), az_manager};
+
+    auto desc = default_description;
+    desc.image.image_path = std::filesystem::path{instance_dir.path().toStdString()} / "img";
+    const auto state_file = QString::fromStdString(
+        mp::QemuVMProcessSpec::suspend_state_path(desc).string());
+
+    auto migrations = 0;
+    auto cancelled = false;
+    process_factory->register_callback([&](mpt::MockProcess* process) {
+        handle_qemu_system(process);
+        if (process->program().contains("qemu-system"))
+        {
+            EXPECT_CALL(*process, wait_for_finished(_)).WillRepeatedly(Return(false));
+            EXPECT_CALL(*process, write(_)).WillRepeatedly([&, process](const QByteArray& data) {
+                auto json = boost::json::parse(std::string_view(data));
+                auto execute = value_to<std::string>(json.at("execute"));
+
+                if (execute == "migrate-set-capabilities" && json.as_object().contains("id"))
+                {
+                    reply_to_qmp(process, "{\"return\": {}, \"id\": \"suspend-capabilities\"}");
+                }
+                else if (execute == "migrate" && migrations++ == 0)
+                {
+                    mpt::make_file_with_content(state_file, "partial state");
+                }
+                else if (execute == "migrate_cancel")
+                {
+                    cancelled = true;
+                    reply_to_qmp(process,
+                                 "{\"event\": \"MIGRATION\", "
+                                 "\"data\": {\"status\": \"cancelled\"}}");
+                }
+                else if (execute == "migrate") // let the instance suspend on destruction
+                {
+                    expect_suspend_kill(process);
+                    reply_to_qmp(process,
+                                 "{\"event\": \"MIGRATION\", "
+                                 "\"data\": {\"status\": \"completed\"}}");
+                }
+
+                return data.size();
+            });
+        }
+    });
+
+    auto machine = backend.create_virtual_machine(desc, key_provider, mock_monitor);
+    machine->start();
+    machine->state = mp::VirtualMachine::State::running;
+
+    logger_scope.mock_logger->screen_logs(mpl::Level::error);
+    logger_scope.mock_logger->expect_log(mpl::Level::error, "Migration cancelled");
+    MP_EXPECT_THROW_THAT(machine->suspend(),
+                         std::runtime_error,
+                         mpt::match_what(HasSubstr("in time, the instance was left running")));
+
+    EXPECT_TRUE(cancelled);
+    EXPECT_FALSE(QFile::exists(state_file));
+    EXPECT_EQ(machine->current_state(), mp::VirtualMachine::State::running);
+}
+
+TEST_F(QemuBackend, suspendFailsWhenQemuExitsWhileMigrating)
+{
+    EXPECT_CALL(*mock_qemu_platform_factory, make_qemu_platform(_, _)).WillOnce([this](auto&&...) {
+        return std::move(mock_qemu_platform);
+    });
+
+    NiceMock<mpt::MockVMStatusMonitor> mock_monitor;
+    mp::QemuVirtualMachineFactory backend{data_dir.path(), az_manager};
+
+    auto desc = default_description;
+    desc.image.image_path = std::filesystem::path{instance_dir.path().toStdString()} / "img";
+    const auto state_file = QString::fromStdString(
+        mp::QemuVMProcessSpec::suspend_state_path(desc).string());
+
+    process_factory->register_callback([&state_file](mpt::MockProcess* process) {
+        handle_qemu_system(process);
+        if (process->program().contains("qemu-system"))
+        {
+            EXPECT_CALL(*process, wait_for_finished(_)).WillRepeatedly(Return(false));
+            EXPECT_CALL(*process, write(_))
+                .WillRepeatedly([&state_file, process](const QByteArray& data) {
+                    auto json = boost::json::parse(std::string_view(data));
+                    auto execute = value_to<std::string>(json.at("execute"));
+
+                    if (execute == "migrate-set-capabilities" && json.as_object().contains("id"))
+                    {
+                        reply_to_qmp(process,
+                                     "{\"return\": {}, \"id\": \"suspend-capabilities\"}");
+                    }
+                    else if (execute == "migrate")
+                    {
+                        mpt::make_file_with_content(state_file, "partial state");
+
+                        EXPECT_CALL(*process, running()).WillRepeatedly(Return(false));
+                        mp::ProcessState exit_state{
+                            std::nullopt,
+                            mp::ProcessState::Error{QProcess::Crashed, QStringLiteral("")}};
+                        emit process->finished(exit_state);
+                    }
+
+                    return data.size();
+                });
+        }
+    });
+
+    auto machine = backend.create_virtual_machine(desc, key_provider, mock_monitor);
+    machine->start();
+    machine->state = mp::VirtualMachine::State::running;
+
+    EXPECT_CALL(mock_monitor, on_shutdown());
+    EXPECT_CALL(mock_monitor, on_suspend()).Times(0);
+    MP_EXPECT_THROW_THAT(machine->suspend(),
+                         std::runtime_error,
+                         mpt::match_what(HasSubstr("stopped before its state was saved")));
+
+    EXPECT_FALSE(QFile::exists(state_file));
+    EXPECT_EQ(machine->current_state(), mp::VirtualMachine::State::off);
+}
+
+TEST_F(QemuBackend, handlesSnapshotsOfRunningInstanceOverQmp)
+{
+    EXPECT_CALL(*mock_qemu_platform_factory, make_qemu_platform(_, _)).WillOnce([this](auto&&...) {
+        return std::move(mock_qemu_platform);
+    });
+
+    NiceMock<mpt::MockVMStatusMonitor> mock_monitor;
+    mp::QemuVirtualMachineFactory backend{data_dir.path(), az_manager};
+
+    std::vector<boost::json::object> commands;
+    auto qemu_img_runs = 0;
+    process_factory->register_callback([&](mpt::MockProcess* process) {
+        handle_qemu_system(process);
+        if (process->program().contains("qemu-img"))
+            ++qemu_img_runs;
+
+        if (process->program().contains("qemu-system"))
+        {
+            auto is_snapshot_command = [](const QByteArray& data) {
+                return data.contains("query-block") || data.contains("blockdev-snapshot");
+            };
+            EXPECT_CALL(*process, write(Truly(is_snapshot_command)))
+                .WillRepeatedly([&commands, process](const QByteArray& data) {
+                    auto qmp = boost::json::parse(std::string_view(data)).as_object();
+                    boost::json::object reply{{"id", qmp.at("id")},
+                                              {"return", boost::json::object{}}};
+                    if (value_to<std::string>(qmp.at("execute")) == "query-block")
+                        reply["return"] = boost::json::parse(
+                            R"([{"device": "hda", "inserted": {"image": {"snapshots": [)"
+                            R"({"id": "1", "name": "@s1"}]}}}])");
+
+                    commands.push_back(std::move(qmp));
+                    const auto reply_line = serialize(reply);
+                    reply_to_qmp(process, reply_line.c_str());
+                    return data.size();
+                });
+        }
+    });
+
+    auto machine = backend.create_virtual_machine(default_description, key_provider, mock_monitor);
+    machine->start();
+    machine->state = mp::VirtualMachine::State::running;
+
+    auto& qemu_machine = dynamic_cast<mp::QemuVirtualMachine&>(*machine);
+    ASSERT_TRUE(qemu_machine.supports_live_snapshots());
+    ASSERT_TRUE(qemu_machine.image_in_use());
+
+    const auto qemu_img_runs_before = qemu_img_runs;
+    EXPECT_TRUE(qemu_machine.image_has_snapshot("@s1"));
+    EXPECT_FALSE(qemu_machine.image_has_snapshot("@s2"));
+    qemu_machine.take_live_image_snapshot("@s2");
+    qemu_machine.delete_live_image_snapshot("@s1");
+
+    EXPECT_EQ(qemu_img_runs, qemu_img_runs_before);
+    ASSERT_EQ(commands.size(), 3); // tags are listed only once
+    EXPECT_EQ(value_to<std::string>(commands[0].at("execute")), "query-block");
+    EXPECT_EQ(value_to<std::string>(commands[1].at("execute")), "blockdev-snapshot-internal-sync");
+    EXPECT_EQ(commands[1].at("arguments").as_object(),
+              (boost::json::object{{"device", "hda"}, {"name", "@s2"}}));
+    EXPECT_EQ(value_to<std::string>(commands[2].at("execute")),
+              "blockdev-snapshot-delete-internal-sync");
+    EXPECT_EQ(commands[2].at("arguments").as_object(),
+              (boost::json::object{{"device", "hda"}, {"name", "@s1"}}));
+}
+
+TEST_F(QemuBackend, liveSnapshotThrowsOnQmpError)
+{
+    EXPECT_CALL(*mock_qemu_platform_factory, make_qemu_platform(_, _)).WillOnce([this](auto&&...) {
+        return std::move(mock_qemu_platform);
+    });
+
+    NiceMock<mpt::MockVMStatusMonitor> mock_monitor;
+    mp::QemuVirtualMachineFactory backend{data_dir.path(), az_manager};
+
+    process_factory->register_callback([](mpt::MockProcess* process) {
+        handle_qemu_system(process);
+        if (process->program().contains("qemu-system"))
+        {
+            auto is_snapshot_command = [](const QByteArray& data) {
+                return data.contains("blockdev-snapshot");
+            };
+            EXPECT_CALL(*process, write(Truly(is_snapshot_command)))
+                .WillOnce([process](const QByteArray& data) {
+                    auto qmp = boost::json::parse(std::string_view(data)).as_object();
+                    boost::json::object reply{{"id", qmp.at("id")},
+                                              {"error", {{"desc", "Device is read-only"}}}};
+
+                    const auto reply_line = serialize(reply);
+                    reply_to_qmp(process, reply_line.c_str());
+                    return data.size();
+                });
+        }
+    });
+
+    auto machine = backend.create_virtual_machine(default_description, key_provider, mock_monitor);
+    machine->start();
+    machine->state = mp::VirtualMachine::State::running;
+
+    auto& qemu_machine = dynamic_cast<mp::QemuVirtualMachine&>(*machine);
+    MP_EXPECT_THROW_THAT(qemu_machine.take_live_image_snapshot("@s1"),
+                         std::runtime_error,
+                         mpt::match_what(AllOf(HasSubstr("blockdev-snapshot-internal-sync"),
+                                               HasSubstr("Device is read-only"))));
+}
+
+TEST_F(QemuBackend, readsQmpRepliesSplitAcrossReads)
+{
+    EXPECT_CALL(*mock_qemu_platform_factory, make_qemu_platform(_, _)).WillOnce([this](auto&&...) {
+        return std::move(mock_qemu_platform);
+    });
+
+    NiceMock<mpt::MockVMStatusMonitor> mock_monitor;
+    mp::QemuVirtualMachineFactory backend{data_dir.path(), az_manager};
+
+    process_factory->register_callback([](mpt::MockProcess* process) {
+        handle_qemu_system(process);
+        if (process->program().contains("qemu-system"))
+        {
+            auto is_query_block = [](const QByteArray& data) {
+                return data.contains("query-block");
+            };
+            EXPECT_CALL(*process, write(Truly(is_query_block)))
+                .WillOnce([process](const QByteArray& data) {
+                    auto qmp = boost::json::parse(std::string_view(data)).as_object();
+                    boost::json::object reply{
+                        {"id", qmp.at("id")},
+                        {"return",
+                         boost::json::parse(
+                             R"([{"device": "hda", "inserted": {"image": {"snapshots": [)"
+                             R"({"id": "1", "name": "@s1"}]}}}])")}};
+
+                    const auto reply_line = QByteArray::fromStdString(serialize(reply)) + "\r\n";
+                    const auto split = reply_line.size() / 2;
+                    EXPECT_CALL(*process, read_all_standard_output())
+                        .WillOnce(Return("{unreadable\r\n" + reply_line.first(split)))
+                        .WillOnce(Return(reply_line.sliced(split)));
+
+                    emit process->ready_read_standard_output();
+                    emit process->ready_read_standard_output();
+                    return data.size();
+                });
+        }
+    });
+
+    auto machine = backend.create_virtual_machine(default_description, key_provider, mock_monitor);
+    machine->start();
+    machine->state = mp::VirtualMachine::State::running;
+
+    logger_scope.mock_logger->expect_log(mpl::Level::warning, "Ignoring unreadable QMP message");
+
+    auto& qemu_machine = dynamic_cast<mp::QemuVirtualMachine&>(*machine);
+    EXPECT_TRUE(qemu_machine.image_has_snapshot("@s1"));
+}
+
+TEST_F(QemuBackend, resumeDiscardsStateFileThatFailsToLoad)
+{
+    EXPECT_CALL(*mock_qemu_platform_factory, make_qemu_platform(_, _)).WillOnce([this](auto&&...) {
+        return std::move(mock_qemu_platform);
+    });
+
+    NiceMock<mpt::MockVMStatusMonitor> mock_monitor;
+    mp::QemuVirtualMachineFactory backend{data_dir.path(), az_manager};
+
+    auto desc = default_description;
+    desc.image.image_path = std::filesystem::path{instance_dir.path().toStdString()} / "img";
+    const auto state_file = QString::fromStdString(
+        mp::QemuVMProcessSpec::suspend_state_path(desc).string());
+    mpt::make_file_with_content(state_file, "truncated state");
+
+    process_factory->register_callback([](mpt::MockProcess* process) {
+        handle_qemu_system(process);
+        if (process->arguments().contains("-incoming"))
+        {
+            EXPECT_CALL(*process, kill()).WillOnce(Return()); // without finishing, to keep it simple
+            EXPECT_CALL(*process, write(_)).WillRepeatedly([process](const QByteArray& data) {
+                auto json = boost::json::parse(std::string_view(data));
+                if (value_to<std::string>(json.at("execute")) == "migrate-incoming")
+                    reply_to_qmp(process,
+                                 "{\"event\": \"MIGRATION\", \"data\": {\"status\": \"failed\"}}");
+
+                return data.size();
+            });
+        }
+    });
+
+    auto machine = backend.create_virtual_machine(desc, key_provider, mock_monitor);
+    ASSERT_EQ(machine->current_state(), mp::VirtualMachine::State::suspended);
+
+    logger_scope.mock_logger->screen_logs(mpl::Level::error);
+    logger_scope.mock_logger->expect_log(mpl::Level::error, "Migration failed");
+    logger_scope.mock_logger->expect_log(mpl::Level::error,
+                                         "Failed to resume from the suspended state");
+    machine->start();
+
+    EXPECT_FALSE(QFile::exists(state_file));
+    machine->state = mp::VirtualMachine::State::off; // as the kill would have left it
+}
+
 TEST_F(QemuBackend, QMPErrorGetsLogged)
 {
     EXPECT_CALL(*mock_qemu_platform_factory, make_qemu_platform(_, _)).WillOnce([this](auto&&...) {
@@ -299,7 +753,7 @@ TEST_F(QemuBackend, QMPErrorGetsLogged)
                                                    // cause an error
                 {
                     EXPECT_CALL(*process, read_all_standard_output())
-                        .WillRepeatedly(Return("{\"error\": {\"desc\": \"some error\"}} "));
+                        .WillRepeatedly(Return("{\"error\": {\"desc\": \"some error\"}}\r\n"));
                     emit process->ready_read_standard_output();
                 }
 
@@ -1196,6 +1650,31 @@ TEST_F(QemuBackend, createsQemuSnapshotsFromSpecs)
     EXPECT_EQ(snapshot->get_parent(), nullptr);
 }
 
+TEST_F(QemuBackend, recordsSnapshotsOfRunningInstanceAsStopped)
+{
+    NiceMock<MockQemuVM> machine{"mock-qemu-vm", key_provider, zone};
+    machine.state = mp::VirtualMachine::State::running;
+
+    const mp::VMSpecs specs{
+        2,
+        mp::MemorySize{"3.21G"},
+        mp::MemorySize{"4.32M"},
+        "00:00:00:00:00:00",
+        {},
+        "asdf",
+        mp::VirtualMachine::State::running,
+        {},
+        false,
+        {},
+        0,
+        "zone1",
+    };
+    auto snapshot = machine.make_specific_snapshot("live", "", "vm1", specs, nullptr);
+
+    // it holds the disk alone, so restoring it leaves the instance stopped
+    EXPECT_EQ(snapshot->get_state(), mp::VirtualMachine::State::off);
+}
+
 TEST_F(QemuBackend, createsQemuSnapshotsFromJsonFile)
 {
     MockQemuVM machine{"mock-qemu-vm", key_provider, zone};
@@ -19,6 +19,7 @@
 #include "tests/unit/mock_file_ops.h"
 #include "tests/unit/mock_logger.h"
 #include "tests/unit/mock_server_reader_writer.h"
+#include "tests/unit/mock_settings.h"
 #include "tests/unit/mock_ssh_process.h"
 #include "tests/unit/mock_ssh_session.h"
 #include "tests/unit/mock_virtual_machine.h"
@@ -27,6 +28,7 @@
 
 #include "qemu_mount_handler.h"
 
+#include <multipass/constants.h>
 #include <multipass/exceptions/ssh_exception.h>
 #include <multipass/utils.h>
 #include <multipass/vm_mount.h>
@@ -150,6 +152,8 @@ struct QemuMountHandlerTest : public ::Test
     mp::VMMount mount{default_source, gid_mappings, uid_mappings, mp::VMMount::MountType::Native};
     mpt::MockFileOps::GuardedMock mock_file_ops_injection = mpt::MockFileOps::inject();
     mpt::MockFileOps& mock_file_ops = *mock_file_ops_injection.first;
+    mpt::MockSettings::GuardedMock mock_settings_injection = mpt::MockSettings::inject<NiceMock>();
+    mpt::MockSettings& mock_settings = *mock_settings_injection.first;
     mpt::MockLogger::Scope logger_scope = mpt::MockLogger::inject(mpl::Level::debug);
     mpt::MockServerReaderWriter<mp::MountReply, mp::MountRequest> server;
     mpt::StubAvailabilityZone zone{};
@@ -210,6 +214,56 @@ TEST_F(QemuMountHandlerTest, mountHandlesMountArgs)
     EXPECT_EQ(mount_args.size(), 0);
 }
 
+TEST_F(QemuMountHandlerTest, mountHandlesVirtiofsArgs)
+{
+    auto& shares = vm.modifiable_virtiofs_shares();
+    const auto tag = QString::fromStdString(tag_from_target(default_target));
+
+    ON_CALL(mock_settings, get(Eq(mp::native_mount_transport_key)))
+        .WillByDefault(Return(mp::native_mount_transport_virtiofs));
+    ON_CALL(mock_settings, get(Eq(mp::virtiofs_cache_key))).WillByDefault(Return("never"));
+
+    {
+        mp::QemuMountHandler handler{&vm, &key_provider, default_target, mount};
+
+        ASSERT_EQ(shares.size(), 1);
+        const auto& share = shares.begin()->second;
+        const auto& socket = share.socket_path();
+        EXPECT_TRUE(socket.startsWith(mp::VirtiofsdProcessSpec::socket_dir() + "/"));
+        EXPECT_LT(socket.toUtf8().size(), 108); // what fits in sockaddr_un
+
+        ASSERT_EQ(mount_args.size(), 1);
+        EXPECT_EQ(mount_args.begin()->second.second,
+                  QStringList({"-chardev",
+                               QString{"socket,id=%1,path=%2"}.arg(tag, socket),
+                               "-device",
+                               QString{"vhost-user-fs-pci,queue-size=1024,chardev=%1,tag=%1"}.arg(
+                                   tag)}));
+
+        EXPECT_THAT(share.arguments(),
+                    AllOf(Contains(QString{"--socket-path=%1"}.arg(socket)),
+                          Contains(QString::fromStdString("--shared-dir=" + default_source)),
+                          Contains("--cache=never"),
+                          Contains("--translate-uid=map:6:5:1"),
+                          Contains("--translate-gid=map:2:1:1")));
+    }
+
+    EXPECT_THAT(mount_args, IsEmpty());
+    EXPECT_THAT(shares, IsEmpty());
+}
+
+TEST_F(QemuMountHandlerTest, recoverVirtiofsFromSuspendedRegardlessOfSettings)
+{
+    mount_args[tag_from_target(default_target)] = {
+        default_source,
+        {"-chardev", "socket,id=tag,path=tag.sock", "-device", "vhost-user-fs-pci,tag=tag"}};
+    EXPECT_CALL(vm, current_state()).WillOnce(Return(mp::VirtualMachine::State::suspended));
+    EXPECT_CALL(mock_settings, get(Eq(mp::native_mount_transport_key))).Times(0);
+
+    mp::QemuMountHandler handler{&vm, &key_provider, default_target, mount};
+    EXPECT_EQ(vm.modifiable_virtiofs_shares().size(), 1);
+}
+
 TEST_F(QemuMountHandlerTest, mountLogsInit)
 {
     logger_scope.mock_logger->expect_log(mpl::Level::info,
@@ -250,6 +304,28 @@ TEST_F(QemuMountHandlerTest, startSuccessStopSuccess)
     EXPECT_NO_THROW(handler.deactivate());
 }
 
+TEST_F(QemuMountHandlerTest, virtiofsStartSuccessStopSuccess)
+{
+    ON_CALL(mock_settings, get(Eq(mp::native_mount_transport_key)))
+        .WillByDefault(Return(mp::native_mount_transport_virtiofs));
+
+    auto session = std::make_unique<NiceMock<mpt::MockSSHSession>>();
+
+    expect_ssh_success(*session, "echo $PWD/target", "/home/ubuntu/target");
+    expect_ssh_success(*session, "P=\"/home/ubuntu/target\"", "/home/ubuntu/target");
+    expect_ssh_success(*session,
+                       fmt::format("sudo mount -t virtiofs {} {}",
+                                   tag_from_target(default_target),
+                                   default_target),
+                       "");
+
+    EXPECT_CALL(vm, new_ssh_session()).WillOnce(Return(std::move(session)));
+
+    mp::QemuMountHandler handler{&vm, &key_provider, default_target, mount};
+    EXPECT_NO_THROW(handler.activate(&server));
+    EXPECT_NO_THROW(handler.deactivate());
+}
+
 TEST_F(QemuMountHandlerTest, stopFailNonforceThrows)
 {
     auto error = "device is busy";
@@ -33,6 +33,7 @@
 
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include <QCoreApplication>
 
@@ -59,6 +60,12 @@ struct PublicQemuSnapshot : public mp::QemuSnapshot
     // clang-format on
 };
 
+struct QemuVMWithDesc : public mpt::MockVirtualMachineT<mp::QemuVirtualMachine>
+{
+    using mpt::MockVirtualMachineT<mp::QemuVirtualMachine>::MockVirtualMachineT;
+    using mp::QemuVirtualMachine::desc;
+};
+
 struct TestQemuSnapshot : public Test
 {
     using ArgsMatcher = Matcher<QStringList>;
@@ -91,18 +98,20 @@ struct TestQemuSnapshot : public Test
     static void set_tag_output(mpt::MockProcess* process, std::string tag)
     {
         EXPECT_CALL(*process, read_all_standard_output)
-            .WillOnce(Return(QByteArray::fromStdString(tag + ' ')));
+            .WillOnce(Return(QByteArray::fromStdString(fmt::format(
+                "Snapshot list:\n"
+                "ID        TAG               VM SIZE                DATE     VM CLOCK     ICOUNT\n"
+                "1         {}                   0 B 2024-06-11 23:22:59 00:00:00.000          0\n",
+                tag))));
     }
 
-    mp::VirtualMachineDescription desc = [] {
-        mp::VirtualMachineDescription ret{};
-        ret.image.image_path = "raniunotuiroleh";
-        return ret;
-    }();
-
     mpt::StubSSHKeyProvider key_provider{};
     mpt::StubAvailabilityZone zone{};
-    NiceMock<mpt::MockVirtualMachineT<mp::QemuVirtualMachine>> vm{"qemu-vm", key_provider, zone};
+    NiceMock<QemuVMWithDesc> vm{"qemu-vm", key_provider, zone};
+    mp::VirtualMachineDescription& desc = [this]() -> mp::VirtualMachineDescription& {
+        vm.desc.image.image_path = "raniunotuiroleh"; // the VM looks its image up in there
+        return vm.desc;
+    }();
     ArgsMatcher list_args_matcher =
         ElementsAre("snapshot", "-l", QString::fromStdString(desc.image.image_path));
     const mpt::MockCloudInitFileOps::GuardedMock mock_cloud_init_file_ops_injection =
@@ -248,6 +257,30 @@ TEST_F(TestQemuSnapshot, captureThrowsOnRepeatedTag)
                                                HasSubstr(desc.image.image_path))));
 }
 
+TEST_F(TestQemuSnapshot, listsImageSnapshotsOnlyOnce)
+{
+    EXPECT_CALL(vm, get_snapshot_count).WillOnce(Return(0)).WillOnce(Return(1));
+
+    std::vector<QStringList> args;
+    auto mock_factory_scope = mpt::MockProcessFactory::Inject();
+    mock_factory_scope->register_callback([&](mpt::MockProcess* process) {
+        set_common_expectations_on(process);
+        args.push_back(process->arguments());
+    });
+
+    auto first = quick_snapshot("first");
+    first.capture();
+    quick_snapshot("second").capture();
+    first.erase();
+
+    const auto image_path = QString::fromStdString(desc.image.image_path);
+    ASSERT_EQ(args.size(), 4);
+    EXPECT_THAT(args[0], list_args_matcher);
+    EXPECT_THAT(args[1], ElementsAre("snapshot", "-c", "@s1", image_path));
+    EXPECT_THAT(args[2], ElementsAre("snapshot", "-c", "@s2", image_path));
+    EXPECT_THAT(args[3], ElementsAre("snapshot", "-d", "@s1", image_path));
+}
+
 TEST_F(TestQemuSnapshot, erasesSnapshot)
 {
     auto snapshot = loaded_snapshot();
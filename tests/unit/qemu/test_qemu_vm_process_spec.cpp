@@ -99,6 +99,29 @@ TEST_F(TestQemuVMProcessSpec, defaultArgumentsCorrect)
                            "path=path/to/target,mount_tag=m810e457178f448d9afffc9d950d726"}));
 }
 
+TEST_F(TestQemuVMProcessSpec, virtiofsMountsShareGuestMemory)
+{
+    const mp::QemuVirtualMachine::MountArgs virtiofs_mount_args{
+        {"mtag",
+         {"path/to/source",
+          {"-chardev",
+           "socket,id=mtag,path=/path/to/mtag.sock",
+           "-device",
+           "vhost-user-fs-pci,queue-size=1024,chardev=mtag,tag=mtag"}}}};
+
+    mp::QemuVMProcessSpec spec(desc, platform_args, virtiofs_mount_args, std::nullopt);
+    const auto args = spec.arguments();
+
+    const auto memory_backend = args.indexOf("memory-backend-memfd,id=mem,size=3072M,share=on");
+    ASSERT_GT(memory_backend, 0);
+    EXPECT_EQ(args[memory_backend - 1], "-object");
+    EXPECT_EQ(args.mid(memory_backend + 1, 2), QStringList({"-numa", "node,memdev=mem"}));
+    EXPECT_EQ(args.mid(args.size() - 4), virtiofs_mount_args.begin()->second.second);
+
+    EXPECT_THAT(spec.apparmor_profile().toStdString(), HasSubstr("/path/to/mtag.sock rw,"));
+    EXPECT_THAT(spec.apparmor_profile().toStdString(), Not(HasSubstr("path/to/source/")));
+}
+
 TEST_F(TestQemuVMProcessSpec, resumeArgumentsTakenFromResumedata)
 {
     const mp::QemuVMProcessSpec::ResumeData resume_data{"suspend_tag",
@@ -151,6 +174,27 @@ TEST_F(TestQemuVMProcessSpec, resumeFixesVmnetFormat)
                   << mount_args.begin()->second.second);
 }
 
+TEST_F(TestQemuVMProcessSpec, resumeFromStateFileWaitsForIncomingMigration)
+{
+    const mp::QemuVMProcessSpec::ResumeData resume_data{"suspend_tag",
+                                                        "machine_type",
+                                                        {"-one", "-two"},
+                                                        true};
+
+    mp::QemuVMProcessSpec spec(desc, platform_args, mount_args, resume_data);
+
+    EXPECT_EQ(spec.arguments(),
+              QStringList({"-L",
+                           spec.firmware_path(),
+                           "-one",
+                           "-two",
+                           "-incoming",
+                           "defer",
+                           "-machine",
+                           "machine_type"})
+                  << mount_args.begin()->second.second);
+}
+
 TEST_F(TestQemuVMProcessSpec, apparmorProfileIncludesFileMountPerms)
 {
     mp::QemuVMProcessSpec spec(desc, platform_args, mount_args, std::nullopt);
@@ -175,6 +219,14 @@ TEST_F(TestQemuVMProcessSpec, apparmorProfileIncludesDiskImages)
     EXPECT_THAT(spec.apparmor_profile().toStdString(), HasSubstr("/path/to/cloud_init.iso rk,"));
 }
 
+TEST_F(TestQemuVMProcessSpec, apparmorProfileIncludesSuspendStateFile)
+{
+    mp::QemuVMProcessSpec spec(desc, platform_args, mount_args, std::nullopt);
+
+    EXPECT_EQ(mp::QemuVMProcessSpec::suspend_state_path(desc).string(), "/path/to/suspend.vmstate");
+    EXPECT_THAT(spec.apparmor_profile().toStdString(), HasSubstr("/path/to/suspend.vmstate rw,"));
+}
+
 TEST_F(TestQemuVMProcessSpec, apparmorProfileIdentifier)
 {
     mp::QemuVMProcessSpec spec(desc, platform_args, mount_args, std::nullopt);
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "tests/unit/common.h"
+#include "tests/unit/mock_environment_helpers.h"
+
+#include <src/platform/backends/qemu/virtiofsd_process_spec.h>
+
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+
+namespace mp = multipass;
+namespace mpt = multipass::test;
+using namespace testing;
+
+struct TestVirtiofsdProcessSpec : public Test
+{
+    using IdMap = mp::VirtiofsdProcessSpec::IdMap;
+
+    mp::VirtiofsdProcessSpec make_spec(const IdMap& uid_map = {1000, 1000},
+                                       const IdMap& gid_map = {1000, 1000})
+    {
+        return {tag, shared_dir, socket, "auto", uid_map, gid_map};
+    }
+
+    const QString tag{"mtag"};
+    const QString shared_dir{"/path/to/source"};
+    const QString socket{"/path/to/instance/mtag.sock"};
+};
+
+TEST_F(TestVirtiofsdProcessSpec, defaultArgumentsCorrect)
+{
+    EXPECT_EQ(make_spec().arguments(),
+              QStringList({"--socket-path=/path/to/instance/mtag.sock",
+                           "--shared-dir=/path/to/source",
+                           "--cache=auto"}));
+}
+
+TEST_F(TestVirtiofsdProcessSpec, translatesIdsOnlyWhenMapped)
+{
+    EXPECT_THAT(make_spec({501, 1000}, {20, 20}).arguments(),
+                AllOf(Contains("--translate-uid=map:1000:501:1"),
+                      Not(Contains(HasSubstr("--translate-gid")))));
+}
+
+TEST_F(TestVirtiofsdProcessSpec, programFoundInSnap)
+{
+    QTemporaryDir snap_dir;
+    mpt::SetEnvScope e1("SNAP", snap_dir.path().toUtf8());
+    mpt::SetEnvScope e2("SNAP_NAME", "multipass");
+
+    EXPECT_EQ(make_spec().program(), snap_dir.path() + "/usr/libexec/virtiofsd");
+}
+
+TEST_F(TestVirtiofsdProcessSpec, apparmorProfileIsPerMount)
+{
+    EXPECT_TRUE(make_spec().apparmor_profile().contains("profile multipass.mtag.virtiofsd "));
+}
+
+TEST_F(TestVirtiofsdProcessSpec, apparmorProfilePermitsSocketAndSharedDir)
+{
+    const auto profile = make_spec().apparmor_profile();
+
+    EXPECT_TRUE(profile.contains("/path/to/instance/mtag.sock rw,"));
+    EXPECT_TRUE(profile.contains("/path/to/source/ rw,"));
+    EXPECT_TRUE(profile.contains("/path/to/source/** rwlk,"));
+}
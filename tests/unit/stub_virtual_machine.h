@@ -93,6 +93,11 @@ struct StubVirtualMachine final : public VirtualMachine
         return {IPAddress{"192.168.2.123"}};
     }
 
+    std::vector<IPAddress> all_ipv4_from(const std::string& /*all_ipv4_cmd_output*/) override
+    {
+        return get_all_ipv4();
+    }
+
     std::string ssh_exec(const std::string& /*cmd*/, bool /*whisper*/ = false) override
     {
         return {};
@@ -173,6 +178,11 @@ struct StubVirtualMachine final : public VirtualMachine
         return nullptr;
     }
 
+    bool supports_live_snapshots() const override
+    {
+        return false;
+    }
+
     std::shared_ptr<const Snapshot> take_snapshot(const VMSpecs&,
                                                   const std::string&,
                                                   const std::string&) override
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common.h"
+
+#include <multipass/logging/async_logger.h>
+#include <multipass/logging/level.h>
+#include <multipass/logging/standard_logger.h>
+
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace mpl = multipass::logging;
+
+using namespace testing;
+
+namespace
+{
+// Records messages, holding up the first one until released
+class GatedLogger : public mpl::Logger
+{
+public:
+    GatedLogger(std::vector<std::string>& messages, std::shared_future<void> gate)
+        : Logger{mpl::Level::trace}, messages{messages}, gate{std::move(gate)}
+    {
+    }
+
+    void log(mpl::Level, std::string_view, std::string_view message) const override
+    {
+        std::call_once(first, [this] {
+            entered.set_value();
+            gate.wait();
+        });
+
+        std::lock_guard lock{mutex};
+        messages.emplace_back(message);
+    }
+
+    mutable std::promise<void> entered;
+
+private:
+    std::vector<std::string>& messages;
+    std::shared_future<void> gate;
+    mutable std::once_flag first;
+    mutable std::mutex mutex;
+};
+
+TEST(AsyncLoggerTests, forwardsMessagesInOrder)
+{
+    std::ostringstream out;
+    {
+        mpl::AsyncLogger logger{std::make_unique<mpl::StandardLogger>(mpl::Level::debug, out)};
+        logger.log(mpl::Level::info, "cat", "one");
+        logger.log(mpl::Level::debug, "cat", "two");
+        logger.log(mpl::Level::error, "cat", "three");
+    } // flushes
+
+    const auto logged = out.str();
+    const auto one = logged.find("[info] [cat] one"), two = logged.find("[debug] [cat] two"),
+               three = logged.find("[error] [cat] three");
+
+    ASSERT_NE(three, std::string::npos);
+    EXPECT_LT(one, two);
+    EXPECT_LT(two, three);
+}
+
+TEST(AsyncLoggerTests, acceptsWhatTheSinkAccepts)
+{
+    std::ostringstream out;
+    {
+        mpl::AsyncLogger logger{std::make_unique<mpl::StandardLogger>(mpl::Level::debug, out)};
+        EXPECT_TRUE(logger.accepts(mpl::Level::debug));
+        EXPECT_FALSE(logger.accepts(mpl::Level::trace));
+
+        logger.log(mpl::Level::trace, "cat", "msg");
+    }
+
+    EXPECT_THAT(out.str(), IsEmpty());
+}
+
+TEST(AsyncLoggerTests, dropsAndReportsMessagesWhenFull)
+{
+    std::vector<std::string> messages;
+    std::promise<void> release;
+    auto sink = std::make_unique<GatedLogger>(messages, release.get_future().share());
+    auto entered = sink->entered.get_future();
+
+    {
+        mpl::AsyncLogger logger{std::move(sink), 2};
+
+        logger.log(mpl::Level::info, "cat", "first");
+        entered.wait(); // the writer is now stuck on "first", with an empty queue
+
+        for (const auto* message : {"a", "b", "c", "d"})
+            logger.log(mpl::Level::info, "cat", message);
+
+        EXPECT_EQ(logger.dropped_messages(), 2u);
+        release.set_value();
+    }
+
+    EXPECT_THAT(messages, ElementsAre("first", HasSubstr("Dropped 2 log messages"), "a", "b"));
+}
+} // namespace
@@ -37,6 +37,7 @@
 #include <multipass/ip_address.h>
 #include <multipass/logging/level.h>
 #include <multipass/snapshot.h>
+#include <multipass/ssh/ssh_process.h>
 #include <multipass/ssh/ssh_session.h>
 #include <multipass/vm_specs.h>
 
@@ -59,6 +60,7 @@ struct MockBaseVirtualMachine : public mpt::MockVirtualMachineT<mp::BaseVirtualM
         const auto& const_self = *this;
         MP_DELEGATE_MOCK_CALLS_ON_BASE(*this, get_name, mp::BaseVirtualMachine);
         MP_DELEGATE_MOCK_CALLS_ON_BASE(*this, get_all_ipv4, mp::BaseVirtualMachine);
+        MP_DELEGATE_MOCK_CALLS_ON_BASE(*this, all_ipv4_from, mp::BaseVirtualMachine);
         MP_DELEGATE_MOCK_CALLS_ON_BASE(*this, view_snapshots, mp::BaseVirtualMachine);
         MP_DELEGATE_MOCK_CALLS_ON_BASE(*this, get_num_snapshots, mp::BaseVirtualMachine);
         MP_DELEGATE_MOCK_CALLS_ON_BASE(*this, take_snapshot, mp::BaseVirtualMachine);
@@ -109,6 +111,7 @@ struct MockBaseVirtualMachine : public mpt::MockVirtualMachineT<mp::BaseVirtualM
                 (const std::string& cmd, bool whisper),
                 (override));
 
+    using mp::BaseVirtualMachine::drop_ssh_session;  // promote to public
     using mp::BaseVirtualMachine::renew_ssh_session; // promote to public
 
     void simulate_state(St state)
@@ -324,6 +327,14 @@ TEST_F(BaseVM, getAllIpv4WorksWhenInstanceIsOff)
     EXPECT_EQ(vm.get_all_ipv4().size(), 0u);
 }
 
+TEST_F(BaseVM, allIpv4FromParsesBatchedOutput)
+{
+    EXPECT_THAT(vm.all_ipv4_from("eth0             UP             192.168.2.168/24 \n"
+                                 "eth1             UP             10.1.2.3/16 metric 100 \n"),
+                ElementsAre(mp::IPAddress{"192.168.2.168"}, mp::IPAddress{"10.1.2.3"}));
+    EXPECT_THAT(vm.all_ipv4_from(""), IsEmpty());
+}
+
 TEST_F(BaseVM, providesInstanceDirectory)
 {
     auto vm_dir = std::make_unique<mpt::TempDir>();
@@ -1360,6 +1371,50 @@ TEST_F(BaseVM, waitForCloudInitNoErrorsAndDoneDoesNotThrow)
     EXPECT_NO_THROW(vm.wait_for_cloud_init(timeout));
 }
 
+TEST_F(BaseVM, waitForCloudInitWaitsInsideTheInstance)
+{
+    vm.simulate_cloud_init();
+    EXPECT_CALL(vm, current_state()).WillRepeatedly(Return(mp::VirtualMachine::State::running));
+    EXPECT_CALL(vm, ssh_exec(AllOf(StartsWith("timeout 1 "), HasSubstr("boot-finished")), _))
+        .WillOnce(Return(""));
+
+    EXPECT_NO_THROW(vm.wait_for_cloud_init(std::chrono::milliseconds{1}));
+}
+
+TEST_F(BaseVM, waitForCloudInitWaitsLessThanTheSSHExitCodeTimeout)
+{
+    vm.simulate_cloud_init();
+    EXPECT_CALL(vm, current_state()).WillRepeatedly(Return(mp::VirtualMachine::State::running));
+    const auto guest_wait = [](const std::string& cmd) {
+        return std::chrono::seconds{std::stoi(cmd.substr(cmd.find(' ') + 1))};
+    };
+    const auto exit_code_timeout = mp::SSHProcess::default_exit_code_timeout;
+    EXPECT_CALL(vm, ssh_exec(ResultOf(guest_wait, Lt(exit_code_timeout)), _)).WillOnce(Return(""));
+
+    EXPECT_NO_THROW(vm.wait_for_cloud_init(std::chrono::minutes{5}));
+}
+
+TEST_F(BaseVM, waitForCloudInitBacksOffBetweenRetries)
+{
+    using namespace std::chrono_literals;
+
+    vm.simulate_cloud_init();
+    EXPECT_CALL(vm, current_state()).WillRepeatedly(Return(mp::VirtualMachine::State::running));
+    EXPECT_CALL(vm, ssh_exec)
+        .WillOnce(Throw(mp::SSHExecFailure{"not yet", 124}))
+        .WillOnce(Throw(mp::SSHExecFailure{"not yet", 124}))
+        .WillOnce(Throw(mp::SSHExecFailure{"not yet", 124}))
+        .WillOnce(Return(""));
+
+    auto [mock_utils_ptr, guard] = mpt::MockUtils::inject();
+    InSequence seq;
+    EXPECT_CALL(*mock_utils_ptr, sleep_for(Eq(100ms)));
+    EXPECT_CALL(*mock_utils_ptr, sleep_for(Eq(200ms)));
+    EXPECT_CALL(*mock_utils_ptr, sleep_for(Eq(400ms)));
+
+    EXPECT_NO_THROW(vm.wait_for_cloud_init(std::chrono::minutes{5}));
+}
+
 TEST_F(BaseVM, waitForCloudInitErrorTimesOutThrows)
 {
     vm.simulate_cloud_init();
@@ -1513,6 +1568,72 @@ TEST_F(BaseVM, sshExecProcessPropagatesNonSSHExceptions)
                          mpt::match_what(HasSubstr("intentional")));
 }
 
+TEST_F(BaseVM, sshExecProcessUsesSpareSessionWhileCachedOneIsBusy)
+{
+    static constexpr auto* cmd = ":";
+
+    auto busy_session = std::make_unique<NiceMock<mpt::MockSSHSession>>();
+    EXPECT_CALL(*busy_session, is_busy).WillRepeatedly(Return(true));
+    EXPECT_CALL(*busy_session, exec).Times(0);
+
+    auto spare_session = std::make_unique<NiceMock<mpt::MockSSHSession>>();
+    EXPECT_CALL(*spare_session, exec(cmd, _));
+
+    EXPECT_CALL(vm, new_ssh_session)
+        .WillOnce(Return(ByMove(std::move(busy_session))))
+        .WillOnce(Return(ByMove(std::move(spare_session))));
+    EXPECT_CALL(vm, make_ssh_process).Times(0);
+    MP_DELEGATE_MOCK_CALLS_ON_BASE(vm, ssh_exec_process, mp::BaseVirtualMachine);
+
+    vm.renew_ssh_session();
+    EXPECT_NO_THROW(vm.ssh_exec_process(cmd));
+}
+
+TEST_F(BaseVM, sshExecProcessReusesIdleSpareSessions)
+{
+    static constexpr auto* cmd = ":";
+
+    auto busy_session = std::make_unique<NiceMock<mpt::MockSSHSession>>();
+    EXPECT_CALL(*busy_session, is_busy).WillRepeatedly(Return(true));
+
+    auto spare_session = std::make_unique<NiceMock<mpt::MockSSHSession>>();
+    EXPECT_CALL(*spare_session, is_connected).WillRepeatedly(Return(true));
+    EXPECT_CALL(*spare_session, exec(cmd, _)).Times(2);
+
+    EXPECT_CALL(vm, new_ssh_session)
+        .WillOnce(Return(ByMove(std::move(busy_session))))
+        .WillOnce(Return(ByMove(std::move(spare_session))));
+    MP_DELEGATE_MOCK_CALLS_ON_BASE(vm, ssh_exec_process, mp::BaseVirtualMachine);
+
+    vm.renew_ssh_session();
+    EXPECT_NO_THROW(vm.ssh_exec_process(cmd));
+    EXPECT_NO_THROW(vm.ssh_exec_process(cmd));
+}
+
+TEST_F(BaseVM, sshExecProcessDiscardsSpareSessionOpenedWhileSessionsWereDropped)
+{
+    static constexpr auto* cmd = ":";
+
+    auto busy_session = std::make_unique<NiceMock<mpt::MockSSHSession>>();
+    EXPECT_CALL(*busy_session, is_busy).WillRepeatedly(Return(true));
+
+    auto stale_session = std::make_unique<NiceMock<mpt::MockSSHSession>>();
+    EXPECT_CALL(*stale_session, exec).Times(0);
+
+    EXPECT_CALL(vm, new_ssh_session)
+        .WillOnce(Return(ByMove(std::move(busy_session))))
+        .WillOnce([this, &stale_session]() -> std::unique_ptr<mp::SSHSession> {
+            vm.drop_ssh_session(); // e.g. the instance is shutting down meanwhile
+            return std::move(stale_session);
+        })
+        .WillOnce(Return(ByMove(std::make_unique<NiceMock<mpt::MockSSHSession>>())));
+    EXPECT_CALL(vm, make_ssh_process(cmd, _));
+    MP_DELEGATE_MOCK_CALLS_ON_BASE(vm, ssh_exec_process, mp::BaseVirtualMachine);
+
+    vm.renew_ssh_session();
+    EXPECT_NO_THROW(vm.ssh_exec_process(cmd));
+}
+
 TEST_F(BaseVM, newSshSessionThrowsIfNotRunning)
 {
     StubBaseVirtualMachine stub{zone};
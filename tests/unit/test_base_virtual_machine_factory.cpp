@@ -16,9 +16,13 @@
  */
 
 #include "common.h"
+#include "mock_cloud_init_file_ops.h"
+#include "mock_file_ops.h"
 #include "mock_logger.h"
 #include "mock_platform.h"
 #include "stub_availability_zone_manager.h"
+#include "stub_ssh_key_provider.h"
+#include "stub_status_monitor.h"
 #include "stub_url_downloader.h"
 #include "temp_dir.h"
 
@@ -69,6 +73,14 @@ struct MockBaseFactory : mp::BaseVirtualMachineFactory
                 (mp::NetworkInterface & net, std::vector<mp::NetworkInterfaceInfo>& host_nets),
                 (override));
     MOCK_METHOD(void, remove_resources_for_impl, (const std::string&), (override));
+    MOCK_METHOD(mp::VirtualMachine::UPtr,
+                clone_vm_impl,
+                (const std::string&,
+                 const mp::VMSpecs&,
+                 const mp::VirtualMachineDescription&,
+                 mp::VMStatusMonitor&,
+                 const mp::SSHKeyProvider&),
+                (override));
 
     std::string base_create_bridge_with(const mp::NetworkInterfaceInfo& interface)
     {
@@ -320,4 +332,45 @@ TEST_F(BaseFactory, prepareNetworkingPreparesEachRequestedNetwork)
     EXPECT_EQ(extra_nets.size(), num_nets);
     EXPECT_THAT(extra_nets, Each(Eq(tag)));
 }
+
+TEST_F(BaseFactory, cloneBareVmCopiesImagesWhenTheyCannotBeCloned)
+{
+    namespace fs = std::filesystem;
+    constexpr auto src_name = "src";
+    constexpr auto dest_name = "dest";
+    constexpr auto image_contents = "image data";
+
+    MockBaseFactory factory{az_manager};
+    const fs::path instances_dir{factory.tmp_dir->path().toStdString()};
+    const fs::path src_dir = instances_dir / src_name;
+    const fs::path dest_dir = instances_dir / dest_name;
+
+    fs::create_directories(src_dir);
+    for (const auto* file : {"disk.img", "cloud-init-config.iso", "snapshot-head"})
+        std::ofstream{src_dir / file} << image_contents;
+
+    auto [mock_file_ops, file_ops_guard] = mpt::MockFileOps::inject<NiceMock>();
+    MP_DELEGATE_MOCK_CALLS_ON_BASE_WITH_MATCHERS(*mock_file_ops, copy, mp::FileOps, (_, _, _));
+    EXPECT_CALL(*mock_file_ops, copy(_, _, _)).Times(2);
+    EXPECT_CALL(*mock_file_ops, clone_file(_, _)).Times(2).WillRepeatedly(Return(false));
+
+    auto [mock_cloud_init_file_ops, cloud_init_guard] = mpt::MockCloudInitFileOps::inject();
+    EXPECT_CALL(*mock_cloud_init_file_ops, update_identifiers(_, _, Eq(dest_name), _));
+    EXPECT_CALL(factory, clone_vm_impl(Eq(src_name), _, _, _, _));
+
+    mpt::StubSSHKeyProvider key_provider;
+    mpt::StubVMStatusMonitor stub_monitor;
+    factory.clone_bare_vm({}, {}, src_name, dest_name, {}, key_provider, stub_monitor);
+
+    std::vector<std::string> copied_files;
+    for (const auto& entry : fs::directory_iterator(dest_dir))
+    {
+        copied_files.push_back(entry.path().filename().string());
+
+        std::ifstream stream{entry.path()};
+        EXPECT_EQ(std::string{std::istreambuf_iterator{stream}, {}}, image_contents);
+    }
+
+    EXPECT_THAT(copied_files, UnorderedElementsAre("disk.img", "cloud-init-config.iso"));
+}
 } // namespace
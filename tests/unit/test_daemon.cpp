@@ -2368,6 +2368,27 @@ TEST_F(Daemon, purgePersistsInstances)
                      NiceMock<mpt::MockServerReaderWriter<mp::PurgeReply, mp::PurgeRequest>>{});
 }
 
+TEST_F(Daemon, persistsOnlyActualStateChanges)
+{
+    const std::string name{"real-zebraphant"};
+    const auto [temp_dir, filename] =
+        plant_instance_json(fmt::format("{{{}}}", fmt::format(valid_template, name, "10")));
+    config_builder.data_directory = temp_dir->path();
+    config_builder.vault = std::make_unique<NiceMock<mpt::MockVMImageVault>>();
+    mp::Daemon daemon{config_builder.build()};
+    mp::VMStatusMonitor& monitor = daemon;
+
+    auto [mock_file_ops, guard] = mpt::MockFileOps::inject<StrictMock>();
+    EXPECT_CALL(*mock_file_ops, write_transactionally(Eq(filename), _))
+        .WillOnce(WithArg<1>([](const QByteArrayView& data) {
+            auto obj = boost::json::parse({data.begin(), data.end()}).as_object();
+            EXPECT_EQ(obj.at("real-zebraphant").at("state"), 4);
+        }));
+
+    monitor.persist_state_for(name, mp::VirtualMachine::State::running);
+    monitor.persist_state_for(name, mp::VirtualMachine::State::running);
+}
+
 TEST_F(Daemon, infoAllReturnsAllInstances)
 {
     const std::string good_instance_name{"good-instance"},
@@ -2397,6 +2418,42 @@ TEST_F(Daemon, infoAllReturnsAllInstances)
     call_daemon_slot(daemon, &mp::Daemon::info, mp::InfoRequest{}, mock_server);
 }
 
+TEST_F(Daemon, infoKeepsRequestedInstanceOrder)
+{
+    std::string instances_json;
+    for (auto i = 10; i < 20; ++i) // more instances than are queried at once
+    {
+        const auto separator = instances_json.empty() ? "" : ",";
+        instances_json += separator + fmt::format(valid_template, fmt::format("instance-{}", i), i);
+    }
+
+    mp::InfoRequest request;
+    std::vector<Matcher<const mp::DetailedInfoItem&>> names_in_order;
+    for (auto i = 19; i >= 10; --i) // ask in the reverse of the order they were stored in
+    {
+        const auto name = fmt::format("instance-{}", i);
+        request.add_instance_snapshot_pairs()->set_instance_name(name);
+        names_in_order.push_back(Property(&mp::DetailedInfoItem::name, name));
+    }
+
+    const auto [temp_dir, __] = plant_instance_json(fmt::format("{{{}}}", instances_json));
+    config_builder.data_directory = temp_dir->path();
+    config_builder.vault = std::make_unique<NiceMock<mpt::MockVMImageVault>>();
+
+    EXPECT_CALL(*use_a_mock_vm_factory(), create_virtual_machine)
+        .WillRepeatedly(WithArg<0>([](const auto& desc) {
+            return std::make_unique<mpt::StubVirtualMachine>(desc.vm_name);
+        }));
+
+    StrictMock<mpt::MockServerReaderWriter<mp::InfoReply, mp::InfoRequest>> mock_server{};
+    EXPECT_CALL(mock_server,
+                Write(Property(&mp::InfoReply::details, ElementsAreArray(names_in_order)), _))
+        .WillOnce(Return(true));
+
+    mp::Daemon daemon{config_builder.build()};
+    call_daemon_slot(daemon, &mp::Daemon::info, request, mock_server);
+}
+
 TEST_F(Daemon, setsPermissionsOnProvidedStoragePath)
 {
     const QString path{"Where all the secrets go"};
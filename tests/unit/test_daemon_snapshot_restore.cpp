@@ -154,6 +154,53 @@ TYPED_TEST(TestDaemonSnapshotRestoreCommon, failsOnActiveInstance)
     EXPECT_THAT(status.error_message(), HasSubstr("stopped"));
 }
 
+TEST_F(TestDaemonSnapshot, failsOnRunningInstanceWithoutLiveSnapshots)
+{
+    mp::SnapshotRequest request{};
+    request.set_instance(mock_instance_name);
+
+    auto [daemon, instance] = build_daemon_with_mock_instance();
+    EXPECT_CALL(*instance, current_state)
+        .WillRepeatedly(Return(mp::VirtualMachine::State::running));
+    EXPECT_CALL(*instance, supports_live_snapshots).WillRepeatedly(Return(false));
+    EXPECT_CALL(*instance, take_snapshot).Times(0);
+
+    auto status = call_daemon_slot(
+        *daemon,
+        &mp::Daemon::snapshot,
+        request,
+        StrictMock<mpt::MockServerReaderWriter<mp::SnapshotReply, mp::SnapshotRequest>>{});
+
+    EXPECT_EQ(status.error_code(), grpc::FAILED_PRECONDITION);
+    EXPECT_THAT(status.error_message(), HasSubstr("only take snapshots of stopped instances"));
+}
+
+TEST_F(TestDaemonSnapshot, snapshotsRunningInstanceWithLiveSnapshots)
+{
+    static constexpr auto* snapshot_name = "gibbon";
+
+    mp::SnapshotRequest request{};
+    request.set_instance(mock_instance_name);
+    request.set_snapshot(snapshot_name);
+
+    auto [daemon, instance] = build_daemon_with_mock_instance();
+    EXPECT_CALL(*instance, current_state)
+        .WillRepeatedly(Return(mp::VirtualMachine::State::running));
+    EXPECT_CALL(*instance, supports_live_snapshots).WillRepeatedly(Return(true));
+
+    auto snapshot = std::make_shared<NiceMock<mpt::MockSnapshot>>();
+    EXPECT_CALL(*snapshot, get_name).WillOnce(Return(snapshot_name));
+    EXPECT_CALL(*instance, take_snapshot(_, Eq(snapshot_name), _)).WillOnce(Return(snapshot));
+
+    auto server = StrictMock<mpt::MockServerReaderWriter<mp::SnapshotReply, mp::SnapshotRequest>>{};
+    EXPECT_CALL(server, Write(Property(&mp::SnapshotReply::snapshot, Eq(snapshot_name)), _))
+        .WillOnce(Return(true));
+
+    auto status = call_daemon_slot(*daemon, &mp::Daemon::snapshot, request, server);
+
+    EXPECT_EQ(status.error_code(), grpc::OK);
+}
+
 TEST_F(TestDaemonSnapshot, failsOnInvalidSnapshotName)
 {
     mp::SnapshotRequest request{};
@@ -76,6 +76,69 @@ TEST_F(FileOps, copy)
     EXPECT_TRUE(MP_FILEOPS.exists(dest_dir, err));
 }
 
+TEST_F(FileOps, copyFileKeepsContentsWhetherOrNotItCanBeCloned)
+{
+    const fs::path dest_file = temp_dir / "copy.txt";
+
+    EXPECT_NO_THROW(MP_FILEOPS.copy(temp_file, dest_file, {}));
+
+    std::ifstream stream{dest_file};
+    EXPECT_EQ(std::string{std::istreambuf_iterator{stream}, {}}, file_content);
+}
+
+TEST_F(FileOps, copyFileDoesNotOverwriteByDefault)
+{
+    const fs::path dest_file = temp_dir / "copy.txt";
+    std::ofstream{dest_file} << "other";
+
+    MP_FILEOPS.copy(temp_file, dest_file, {}, err);
+
+    EXPECT_TRUE(err);
+    std::ifstream stream{dest_file};
+    EXPECT_EQ(std::string{std::istreambuf_iterator{stream}, {}}, "other");
+}
+
+TEST_F(FileOps, copyFileFallsBackWhenCloningFails)
+{
+    const auto [mock_file_ops, _] = mpt::MockFileOps::inject<StrictMock>();
+    const fs::path dest_file = temp_dir / "copy.txt";
+
+    EXPECT_CALL(*mock_file_ops, clone_file(Eq(temp_file), Eq(dest_file))).WillOnce(Return(false));
+
+    EXPECT_NO_THROW(mock_file_ops->FileOps::copy(temp_file, dest_file, {}));
+
+    std::ifstream stream{dest_file};
+    EXPECT_EQ(std::string{std::istreambuf_iterator{stream}, {}}, file_content);
+}
+
+TEST_F(FileOps, copyFileSkipsRegularCopyWhenCloned)
+{
+    const auto [mock_file_ops, _] = mpt::MockFileOps::inject<StrictMock>();
+    const fs::path dest_file = temp_dir / "copy.txt";
+
+    EXPECT_CALL(*mock_file_ops, clone_file(Eq(temp_file), Eq(dest_file))).WillOnce(Return(true));
+
+    mock_file_ops->FileOps::copy(temp_file, dest_file, {}, err);
+
+    EXPECT_FALSE(err);
+    EXPECT_FALSE(fs::exists(dest_file));
+}
+
+TEST_F(FileOps, copySymlinkRecreatesLinkInsteadOfCloningTarget)
+{
+    const auto [mock_file_ops, _] = mpt::MockFileOps::inject<StrictMock>();
+    const fs::path link = temp_dir / "link";
+    const fs::path dest_link = temp_dir / "link_copy";
+    fs::create_symlink(temp_file, link);
+
+    EXPECT_CALL(*mock_file_ops, clone_file).Times(0);
+
+    EXPECT_NO_THROW(mock_file_ops->FileOps::copy(link, dest_link, fs::copy_options::copy_symlinks));
+
+    EXPECT_TRUE(fs::is_symlink(dest_link));
+    EXPECT_EQ(fs::read_symlink(dest_link), temp_file);
+}
+
 TEST_F(FileOps, isDirectory)
 {
     EXPECT_TRUE(MP_FILEOPS.is_directory(temp_dir, err));
@@ -187,6 +250,17 @@ TEST_F(FileOps, posixLseek)
     EXPECT_STREQ(buffer.data(), file_content.c_str() + seek);
 }
 
+TEST_F(FileOps, posixPread)
+{
+    const auto named_fd = MP_FILEOPS.open_fd(temp_file, O_RDWR, 0);
+    const auto offset = 3;
+    std::array<char, 100> buffer{};
+    const auto r = MP_FILEOPS.pread(named_fd->fd, buffer.data(), buffer.size(), offset);
+    EXPECT_EQ(r, file_content.size() - offset);
+    EXPECT_STREQ(buffer.data(), file_content.c_str() + offset);
+    EXPECT_EQ(MP_FILEOPS.lseek(named_fd->fd, 0, SEEK_CUR), 0);
+}
+
 TEST_F(FileOps, removeExtension)
 {
     EXPECT_EQ(MP_FILEOPS.remove_extension(""), "");
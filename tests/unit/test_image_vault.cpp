@@ -20,6 +20,7 @@
 #include "file_operations.h"
 #include "mock_file_ops.h"
 #include "mock_image_host.h"
+#include "mock_image_vault_utils.h"
 #include "mock_logger.h"
 #include "mock_process_factory.h"
 #include "path.h"
@@ -37,6 +38,7 @@
 #include <multipass/format.h>
 #include <multipass/platform.h>
 #include <multipass/query.h>
+#include <multipass/rpc/multipass.grpc.pb.h>
 #include <multipass/url_downloader.h>
 #include <multipass/utils.h>
 
@@ -45,6 +47,7 @@
 #include <QUrl>
 
 #include <future>
+#include <vector>
 
 namespace mp = multipass;
 namespace mpl = multipass::logging;
@@ -840,6 +843,65 @@ TEST_F(ImageVault, hashMismatchThrows)
         mp::CreateImageException);
 }
 
+TEST_F(ImageVault, compressedImageIsVerifiedWhileExtracting)
+{
+    auto mock_utils_guard = mpt::MockImageVaultUtils::inject<StrictMock>();
+    auto& mock_utils = *mock_utils_guard.first;
+    host.mock_bionic_image_info.image_location += ".xz";
+
+    EXPECT_CALL(mock_utils, verify_file_hash(_, mpt::default_id))
+        .WillOnce(Throw(std::runtime_error{"Hash does not match"}));
+    EXPECT_CALL(mock_utils, extract_file(_, _, false))
+        .WillOnce(Throw(std::runtime_error{"xz file is corrupt"}));
+
+    mp::DefaultVMImageVault vault{hosts,
+                                  &url_downloader,
+                                  cache_dir.path(),
+                                  data_dir.path(),
+                                  mp::days{0}};
+    MP_EXPECT_THROW_THAT(
+        vault.fetch_image(default_query, stub_prepare, stub_monitor, std::nullopt, instance_dir),
+        mp::CreateImageException,
+        mpt::match_what(HasSubstr("Hash does not match")));
+}
+
+TEST_F(ImageVault, compressedImageReportsVerificationAfterExtracting)
+{
+    auto mock_utils_guard = mpt::MockImageVaultUtils::inject<StrictMock>();
+    auto& mock_utils = *mock_utils_guard.first;
+    host.mock_bionic_image_info.image_location += ".xz";
+
+    std::vector<int> phases;
+    mp::ProgressMonitor monitor{[&phases](int progress_type, int) {
+        phases.push_back(progress_type);
+        return true;
+    }};
+
+    EXPECT_CALL(mock_utils, verify_file_hash(_, mpt::default_id));
+    EXPECT_CALL(mock_utils, extract_file(_, _, false))
+        .WillOnce([&phases](const std::filesystem::path& path,
+                            const mp::ImageVaultUtils::Decoder&,
+                            bool) {
+            EXPECT_THAT(phases, Not(Contains(mp::LaunchProgress::VERIFY)));
+            return std::filesystem::path{path}.replace_extension();
+        });
+
+    // stop right after the image is verified
+    mp::VMImageVault::PrepareAction failing_prepare{
+        [](const mp::VMImage&) -> mp::VMImage { throw std::runtime_error{"not preparing"}; }};
+
+    mp::DefaultVMImageVault vault{hosts,
+                                  &url_downloader,
+                                  cache_dir.path(),
+                                  data_dir.path(),
+                                  mp::days{0}};
+    EXPECT_THROW(
+        vault.fetch_image(default_query, failing_prepare, monitor, std::nullopt, instance_dir),
+        mp::CreateImageException);
+
+    EXPECT_THAT(phases, Contains(mp::LaunchProgress::VERIFY));
+}
+
 TEST_F(ImageVault, invalidRemoteThrows)
 {
     mpt::StubURLDownloader stub_url_downloader;
@@ -125,6 +125,14 @@ TEST_F(TestImageVaultUtils, computeHashComputesSha512)
               "d72a39b3724be768d69250cafd30fef947fe829711f2");
 }
 
+TEST_F(TestImageVaultUtils, computeHashSpansSeveralReads)
+{
+    std::istringstream stream{std::string(3 * 1024 * 1024 + 1, 'a')};
+
+    auto hash = MP_IMAGE_VAULT_UTILS.compute_hash(stream);
+    EXPECT_EQ(hash, "2b98b70051781969f52a33c9cd0e8392bb7a634a92a3be4597b25e13feb41ee6");
+}
+
 TEST_F(TestImageVaultUtils, computeHashUnsupportedHashAlgorithm)
 {
     std::istringstream stream{":)"};
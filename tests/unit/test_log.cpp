@@ -19,6 +19,9 @@
 
 #include <gtest/gtest.h>
 #include <multipass/logging/level.h>
+#include <multipass/logging/standard_logger.h>
+
+#include <sstream>
 
 namespace mpl = multipass::logging;
 namespace mpt = multipass::test;
@@ -103,3 +106,17 @@ TEST_F(LogTests, testLogTraceFunction)
     logger_scope.mock_logger->expect_log(mpl::Level::trace, "with formatting 1");
     mpl::trace("test_category", "with formatting {}", 1);
 }
+
+TEST(LogLevelGating, skipsFormattingForLevelsNobodyLogs)
+{
+    std::ostringstream out;
+    mpl::set_logger(std::make_shared<mpl::StandardLogger>(mpl::Level::warning, out));
+
+    // a broken format would throw if it were evaluated
+    EXPECT_NO_THROW(mpl::log(mpl::Level::debug, "test_category", fmt::runtime("{} {}"), 1));
+    EXPECT_THROW(mpl::log(mpl::Level::error, "test_category", fmt::runtime("{} {}"), 1),
+                 fmt::format_error);
+
+    mpl::set_logger(nullptr);
+    EXPECT_THAT(out.str(), testing::IsEmpty());
+}
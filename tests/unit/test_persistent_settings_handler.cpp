@@ -29,6 +29,8 @@
 
 #include <QString>
 
+#include <chrono>
+#include <filesystem>
 #include <functional>
 #include <optional>
 
@@ -253,6 +255,92 @@ TEST_F(TestPersistentSettingsHandler, getReturnsDefaultByDefault)
     ASSERT_EQ(handler.get(key), QString(default_));
 }
 
+TEST_F(TestPersistentSettingsHandler, getReadsFileOnlyOnceWhileUnchanged)
+{
+    const auto key = "some.key", val = "some value";
+    const auto handler = make_handler(key);
+
+    EXPECT_CALL(*mock_file_ops, last_write_time(_, _))
+        .WillRepeatedly(Return(std::filesystem::file_time_type{std::chrono::seconds{123}}));
+    EXPECT_CALL(*mock_qsettings, value_impl(Eq(key), _)).WillOnce(Return(val));
+
+    inject_mock_qsettings(); // only once
+
+    EXPECT_EQ(handler.get(key), QString{val});
+    EXPECT_EQ(handler.get(key), QString{val});
+}
+
+TEST_F(TestPersistentSettingsHandler, getRereadsFileAfterItChanges)
+{
+    const auto key = "some.key", old_val = "old", new_val = "new";
+    const auto handler = make_handler(key);
+
+    EXPECT_CALL(*mock_file_ops, last_write_time(_, _))
+        .WillOnce(Return(std::filesystem::file_time_type{std::chrono::seconds{123}}))
+        .WillOnce(Return(std::filesystem::file_time_type{std::chrono::seconds{456}}));
+
+    auto changed_qsettings = std::make_unique<NiceMock<mpt::MockQSettings>>();
+    EXPECT_CALL(*mock_qsettings, value_impl(Eq(key), _)).WillOnce(Return(old_val));
+    EXPECT_CALL(*changed_qsettings, value_impl(Eq(key), _)).WillOnce(Return(new_val));
+    EXPECT_CALL(*mock_qsettings_provider,
+                make_wrapped_qsettings(Eq(fake_filename), Eq(QSettings::IniFormat)))
+        .WillOnce(Return(ByMove(std::move(mock_qsettings))))
+        .WillOnce(Return(ByMove(std::move(changed_qsettings))));
+
+    EXPECT_EQ(handler.get(key), QString{old_val});
+    EXPECT_EQ(handler.get(key), QString{new_val});
+}
+
+TEST_F(TestPersistentSettingsHandler, getRereadsFileChangedWithinTheSameStamp)
+{
+    const auto key = "some.key", old_val = "old", new_val = "new";
+    const auto handler = make_handler(key);
+
+    // Two writes that land in the same tick of the file system's clock
+    EXPECT_CALL(*mock_file_ops, last_write_time(_, _))
+        .WillRepeatedly(Return(std::filesystem::file_time_type::clock::now()));
+
+    auto changed_qsettings = std::make_unique<NiceMock<mpt::MockQSettings>>();
+    EXPECT_CALL(*mock_qsettings, value_impl(Eq(key), _)).WillOnce(Return(old_val));
+    EXPECT_CALL(*changed_qsettings, value_impl(Eq(key), _)).WillOnce(Return(new_val));
+    EXPECT_CALL(*mock_qsettings_provider,
+                make_wrapped_qsettings(Eq(fake_filename), Eq(QSettings::IniFormat)))
+        .WillOnce(Return(ByMove(std::move(mock_qsettings))))
+        .WillOnce(Return(ByMove(std::move(changed_qsettings))));
+
+    EXPECT_EQ(handler.get(key), QString{old_val});
+    EXPECT_EQ(handler.get(key), QString{new_val});
+}
+
+TEST_F(TestPersistentSettingsHandler, getThrowsOnCachedSettingWhenFileBecomesUnreadable)
+{
+    const auto key = "some.key", val = "some value";
+    const auto handler = make_handler(key);
+
+    EXPECT_CALL(*mock_file_ops, last_write_time(_, _))
+        .WillRepeatedly(Return(std::filesystem::file_time_type{std::chrono::seconds{123}}));
+    EXPECT_CALL(*mock_file_ops,
+                open(_, Eq(MP_PLATFORM.qstr_to_path(fake_filename)), Eq(std::ios_base::in)))
+        .WillOnce(Return()) // readable on the first read
+        .WillRepeatedly(
+            DoAll(WithArg<0>([](auto& stream) { stream.setstate(std::ios_base::failbit); }),
+                  Assign(&errno, EACCES)));
+
+    auto unreadable_qsettings = std::make_unique<NiceMock<mpt::MockQSettings>>();
+    EXPECT_CALL(*mock_qsettings, value_impl(Eq(key), _)).WillOnce(Return(val));
+    EXPECT_CALL(*mock_qsettings, fileName).WillRepeatedly(Return(fake_filename));
+    EXPECT_CALL(*unreadable_qsettings, fileName).WillRepeatedly(Return(fake_filename));
+    EXPECT_CALL(*mock_qsettings_provider,
+                make_wrapped_qsettings(Eq(fake_filename), Eq(QSettings::IniFormat)))
+        .WillOnce(Return(ByMove(std::move(mock_qsettings))))
+        .WillOnce(Return(ByMove(std::move(unreadable_qsettings))));
+
+    EXPECT_EQ(handler.get(key), QString{val});
+    MP_EXPECT_THROW_THAT(handler.get(key),
+                         mp::PersistentSettingsException,
+                         mpt::match_what(AllOf(HasSubstr("read"), HasSubstr("access"))));
+}
+
 TEST_F(TestPersistentSettingsHandler, getThrowsOnUnknownKey)
 {
     const auto key = "clef";
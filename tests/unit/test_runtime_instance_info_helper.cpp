@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common.h"
+#include "mock_virtual_machine.h"
+
+#include <multipass/format.h>
+#include <multipass/ip_address.h>
+#include <multipass/rpc/multipass.grpc.pb.h>
+
+#include <src/daemon/runtime_instance_info_helper.h>
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace mp = multipass;
+namespace mpt = mp::test;
+using namespace testing;
+
+namespace
+{
+// Output of all_ipv4_cmd as the instance reports it, joined into a single YAML value; what the VM
+// should be given to parse back; and the addresses it finds in there
+using AllIPv4Case = std::tuple<std::string, std::string, std::vector<std::string>>;
+
+struct TestRuntimeInstanceInfoHelper : public TestWithParam<AllIPv4Case>
+{
+    // What the composite command prints, one "key: value" line per bit of information
+    static std::string runtime_info_output(const std::string& all_ipv4)
+    {
+        return fmt::format("loadavg: 0.01 0.02 0.03\n"
+                           "mem_usage: 123\n"
+                           "mem_total: 456\n"
+                           "disk_usage: 789\n"
+                           "disk_total: 1011\n"
+                           "cpus: 2\n"
+                           "cpu_times: cpu  1 2 3 4\n"
+                           "uptime: 3 minutes\n"
+                           "current_release: Ubuntu 24.04 LTS\n"
+                           "all_ipv4: {}\n",
+                           all_ipv4);
+    }
+
+    NiceMock<mpt::MockVirtualMachine> vm{};
+    mp::DetailedInfoItem info{};
+    mp::InstanceDetails* instance_info = info.mutable_instance_info();
+};
+
+TEST_P(TestRuntimeInstanceInfoHelper, parsesAllIPv4Back)
+{
+    const auto& [joined_output, expected_output, addresses] = GetParam();
+    const auto management_ip = mp::IPAddress{"10.0.0.1"};
+
+    std::vector<mp::IPAddress> found{management_ip};
+    std::vector<std::string> expected_ipv4{management_ip.as_string()};
+    for (const auto& address : addresses)
+    {
+        found.emplace_back(address);
+        expected_ipv4.push_back(address);
+    }
+
+    EXPECT_CALL(vm, ssh_exec(_, true)).WillOnce(Return(runtime_info_output(joined_output)));
+    EXPECT_CALL(vm, management_ipv4).WillOnce(Return(management_ip));
+    EXPECT_CALL(vm, all_ipv4_from(Eq(expected_output))).WillOnce(Return(found));
+
+    mp::RuntimeInstanceInfoHelper::populate_runtime_info(vm,
+                                                         &info,
+                                                         instance_info,
+                                                         "original",
+                                                         /* parallelize = */ false);
+
+    EXPECT_THAT(instance_info->ipv4(), ElementsAreArray(expected_ipv4));
+    EXPECT_EQ(instance_info->current_release(), "Ubuntu 24.04 LTS");
+    EXPECT_EQ(info.cpu_count(), "2");
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    TestRuntimeInstanceInfoHelper,
+    TestRuntimeInstanceInfoHelper,
+    Values(AllIPv4Case{"", "", {}},
+           AllIPv4Case{"eth0             UP             10.0.0.2/24 ;",
+                       "eth0             UP             10.0.0.2/24 \n",
+                       {"10.0.0.2"}},
+           AllIPv4Case{"eth0             UP             10.0.0.2/24 ;"
+                       "eth1             UP             10.1.0.2/24 10.1.0.3/24 ;",
+                       "eth0             UP             10.0.0.2/24 \n"
+                       "eth1             UP             10.1.0.2/24 10.1.0.3/24 \n",
+                       {"10.0.0.2", "10.1.0.2", "10.1.0.3"}}));
+} // namespace
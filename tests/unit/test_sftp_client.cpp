@@ -31,6 +31,9 @@
 
 #include <fmt/std.h>
 
+#include <cstring>
+#include <numeric>
+
 namespace mp = multipass;
 namespace mpt = multipass::test;
 namespace mpl = multipass::logging;
@@ -102,6 +105,49 @@ struct SFTPClient : public testing::Test
     MockScope<decltype(mock_sftp_free)> free_sftp;
     MockScope<decltype(mock_sftp_close)> close_sftp;
 
+    // Asynchronous requests are emulated on top of the synchronous mocks, so that tests can keep
+    // replacing sftp_read and sftp_write to describe the remote file.
+    struct FakeAio
+    {
+        sftp_file file;
+        size_t len;
+        ssize_t result;
+    };
+    MockScope<decltype(mock_sftp_aio_begin_write)> aio_begin_write{
+        mock_sftp_aio_begin_write,
+        [](sftp_file file, const void* buf, size_t len, sftp_aio* aio) -> ssize_t {
+            const auto result = mock_sftp_write(file, buf, len);
+            *aio = reinterpret_cast<sftp_aio>(new FakeAio{file, len, result});
+            return len;
+        }};
+    MockScope<decltype(mock_sftp_aio_wait_write)> aio_wait_write{
+        mock_sftp_aio_wait_write,
+        [](sftp_aio* aio) -> ssize_t {
+            auto fake = reinterpret_cast<FakeAio*>(std::exchange(*aio, nullptr));
+            const auto result = fake->result;
+            delete fake;
+            return result;
+        }};
+    MockScope<decltype(mock_sftp_aio_begin_read)> aio_begin_read{
+        mock_sftp_aio_begin_read,
+        [](sftp_file file, size_t len, sftp_aio* aio) -> ssize_t {
+            *aio = reinterpret_cast<sftp_aio>(new FakeAio{file, len, 0});
+            return len;
+        }};
+    MockScope<decltype(mock_sftp_aio_wait_read)> aio_wait_read{
+        mock_sftp_aio_wait_read,
+        [](sftp_aio* aio, void* buf, size_t buf_size) -> ssize_t {
+            auto fake = reinterpret_cast<FakeAio*>(std::exchange(*aio, nullptr));
+            const auto result = mock_sftp_read(fake->file, buf, std::min(fake->len, buf_size));
+            delete fake;
+            return result;
+        }};
+    MockScope<decltype(mock_sftp_aio_free)> aio_free{
+        mock_sftp_aio_free,
+        [](sftp_aio aio) { delete reinterpret_cast<FakeAio*>(aio); }};
+    MockScope<decltype(mock_sftp_seek64)> seek64{mock_sftp_seek64,
+                                                 [](auto...) { return SSH_OK; }};
+
     sftp_limits_struct limits{32768, 32768, 32768, 0};
 
     const mpt::StubSSHKeyProvider key_provider;
@@ -188,6 +234,40 @@ TEST_F(SFTPClient, pushFileSuccess)
     EXPECT_EQ(static_cast<mode_t>(status.permissions()), written_perms);
 }
 
+TEST_F(SFTPClient, pushFileKeepsSeveralWritesInFlight)
+{
+    const std::string test_data(3 * limits.max_write_length, 'x');
+
+    REPLACE_SFTP_INIT();
+    EXPECT_CALL(*mock_file_ops, is_directory(source_path, _)).WillOnce(Return(false));
+    EXPECT_CALL(*mock_sftp_utils, get_remote_file_target(_, source_path, target_path, _))
+        .WillOnce(Return(target_path));
+    EXPECT_CALL(*mock_file_ops, open_read(source_path, _))
+        .WillOnce(Return(std::make_unique<std::stringstream>(test_data)));
+    EXPECT_CALL(*mock_file_ops, status(source_path, _))
+        .WillOnce(Return(fs::file_status{fs::file_type::regular, fs::perms::all}));
+    REPLACE(sftp_open, [](auto sftp, auto...) { return get_dummy_sftp_file(sftp); });
+    REPLACE(sftp_chmod, [](auto...) { return SSH_FX_OK; });
+
+    std::vector<std::string> requests;
+    REPLACE(sftp_write, [&](auto, auto, auto size) {
+        requests.emplace_back("write");
+        return size;
+    });
+    REPLACE(sftp_aio_wait_write, [&](sftp_aio* aio) -> ssize_t {
+        requests.emplace_back("wait");
+        auto fake = reinterpret_cast<FakeAio*>(std::exchange(*aio, nullptr));
+        const auto result = fake->result;
+        delete fake;
+        return result;
+    });
+
+    auto sftp_client = make_sftp_client();
+
+    EXPECT_TRUE(sftp_client.push(source_path, target_path));
+    EXPECT_THAT(requests, ElementsAre("write", "write", "write", "wait", "wait", "wait"));
+}
+
 TEST_F(SFTPClient, pushFileCannotOpenSource)
 {
     REPLACE_SFTP_INIT();
@@ -349,6 +429,42 @@ TEST_F(SFTPClient, pullFileSuccess)
     EXPECT_EQ(static_cast<std::filesystem::perms>(perms), written_perms);
 }
 
+TEST_F(SFTPClient, pullFileReassemblesPipelinedReads)
+{
+    std::string test_data(3 * limits.max_read_length + 10, 'x');
+    std::iota(test_data.begin(), test_data.end(), 0);
+
+    REPLACE_SFTP_INIT();
+    EXPECT_CALL(*mock_sftp_utils, get_local_file_target(source_path, target_path, _))
+        .WillOnce(Return(target_path));
+
+    std::stringstream test_file;
+    EXPECT_CALL(*mock_file_ops, open_write(target_path, _))
+        .WillOnce(Return(std::make_unique<std::ostream>(test_file.rdbuf())));
+    REPLACE(sftp_open, [](auto sftp, auto...) { return get_dummy_sftp_file(sftp); });
+    REPLACE(sftp_stat, [](auto...) { return get_dummy_sftp_attr(); });
+    EXPECT_CALL(mock_platform, set_permissions(target_path, _, _)).WillOnce(Return(true));
+
+    size_t position = 0;
+    REPLACE(sftp_read, [&](auto, void* data, size_t size) {
+        const auto count = std::min(size, test_data.size() - position);
+        std::memcpy(data, test_data.data() + position, count);
+        position += count;
+        return count;
+    });
+    uint64_t seek_offset = 0;
+    REPLACE(sftp_seek64, [&](auto, uint64_t offset) {
+        seek_offset = offset;
+        return SSH_OK;
+    });
+
+    auto sftp_client = make_sftp_client();
+
+    EXPECT_TRUE(sftp_client.pull(source_path, target_path));
+    EXPECT_EQ(test_file.str(), test_data);
+    EXPECT_EQ(seek_offset, test_data.size());
+}
+
 TEST_F(SFTPClient, pullFileCannotOpenSource)
 {
     REPLACE_SFTP_INIT();
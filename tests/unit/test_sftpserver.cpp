@@ -40,6 +40,8 @@
 #include <algorithm>
 #include <queue>
 
+#include <sys/stat.h>
+
 namespace mp = multipass;
 namespace mpl = multipass::logging;
 namespace mpt = multipass::test;
@@ -2049,6 +2051,101 @@ TEST_F(SftpServer, handlesReaddirAttributesPreserved)
     EXPECT_TRUE(compare_permission(test_file_attrs.permissions, test_file_info, Permission::Other));
 }
 
+TEST_F(SftpServer, statAfterReaddirUsesListedAttributes)
+{
+    mpt::TempDir temp_dir;
+    auto test_file = temp_dir.path() + "/test-file";
+    mpt::make_file_with_content(test_file, "some content");
+
+    auto init_msg = make_msg(SSH_FXP_INIT);
+    auto readdir_msg = make_msg(SFTP_READDIR);
+    auto stat_msg = make_msg(SFTP_LSTAT);
+    auto name = name_as_char_array(test_file.toStdString());
+    stat_msg->filename = name.data();
+
+    const mp::fs::path entry_path{test_file.toStdString()};
+    auto entries_read = 0ul;
+    auto directory_entry = mpt::MockDirectoryEntry{};
+    EXPECT_CALL(directory_entry, path).WillRepeatedly(ReturnRef(entry_path));
+    auto dir_iterator = mpt::MockDirIterator{};
+    EXPECT_CALL(dir_iterator, hasNext).WillRepeatedly([&] { return entries_read == 0; });
+    EXPECT_CALL(dir_iterator, next)
+        .WillRepeatedly(DoAll([&] { entries_read++; }, ReturnRef(directory_entry)));
+
+    REPLACE(sftp_handle, [&dir_iterator](auto...) { return &dir_iterator; });
+    REPLACE(sftp_reply_names_add, [](auto...) { return SSH_OK; });
+    REPLACE(sftp_reply_names, [](auto...) { return SSH_OK; });
+
+    // The file disappears after being listed, but the listing is recent enough to answer the stat
+    REPLACE(sftp_get_client_message,
+            [&, handler = make_msg_handler()](auto... args) mutable {
+                auto msg = handler(args...);
+                if (msg == stat_msg.get())
+                    QFile::remove(test_file);
+                return msg;
+            });
+
+    int num_calls{0};
+    REPLACE(sftp_reply_attr, [&](sftp_client_message reply_msg, sftp_attributes attr) {
+        EXPECT_EQ(reply_msg, stat_msg.get());
+        EXPECT_EQ(attr->size, 12u);
+        ++num_calls;
+        return SSH_OK;
+    });
+
+    auto sftp = make_sftpserver(temp_dir.path().toStdString());
+    sftp.run();
+
+    EXPECT_EQ(num_calls, 1);
+}
+
+TEST_F(SftpServer, modifyingMessageDiscardsListedAttributes)
+{
+    mpt::TempDir temp_dir;
+    auto test_file = temp_dir.path() + "/test-file";
+    mpt::make_file_with_content(test_file);
+
+    auto init_msg = make_msg(SSH_FXP_INIT);
+    auto readdir_msg = make_msg(SFTP_READDIR);
+    auto remove_msg = make_msg(SFTP_REMOVE);
+    auto stat_msg = make_msg(SFTP_LSTAT);
+    auto name = name_as_char_array(test_file.toStdString());
+    remove_msg->filename = name.data();
+    stat_msg->filename = name.data();
+
+    const mp::fs::path entry_path{test_file.toStdString()};
+    auto entries_read = 0ul;
+    auto directory_entry = mpt::MockDirectoryEntry{};
+    EXPECT_CALL(directory_entry, path).WillRepeatedly(ReturnRef(entry_path));
+    auto dir_iterator = mpt::MockDirIterator{};
+    EXPECT_CALL(dir_iterator, hasNext).WillRepeatedly([&] { return entries_read == 0; });
+    EXPECT_CALL(dir_iterator, next)
+        .WillRepeatedly(DoAll([&] { entries_read++; }, ReturnRef(directory_entry)));
+
+    REPLACE(sftp_handle, [&dir_iterator](auto...) { return &dir_iterator; });
+    REPLACE(sftp_reply_names_add, [](auto...) { return SSH_OK; });
+    REPLACE(sftp_reply_names, [](auto...) { return SSH_OK; });
+    REPLACE(sftp_get_client_message, make_msg_handler());
+
+    std::vector<uint32_t> statuses;
+    REPLACE(sftp_reply_status, [&statuses](auto, uint32_t status, auto) {
+        statuses.push_back(status);
+        return SSH_OK;
+    });
+
+    int num_attr_calls{0};
+    REPLACE(sftp_reply_attr, [&num_attr_calls](auto...) {
+        ++num_attr_calls;
+        return SSH_OK;
+    });
+
+    auto sftp = make_sftpserver(temp_dir.path().toStdString());
+    sftp.run();
+
+    EXPECT_EQ(num_attr_calls, 0);
+    EXPECT_THAT(statuses, ElementsAre(SSH_FX_OK, SSH_FX_NO_SUCH_FILE));
+}
+
 TEST_F(SftpServer, handlesClose)
 {
     mpt::TempDir temp_dir;
@@ -2640,12 +2737,11 @@ TEST_F(SftpServer, handlesReads)
     const auto named_fd = std::make_pair(path, fd);
 
     const auto [file_ops, mock_file_ops_guard] = mpt::MockFileOps::inject();
-    EXPECT_CALL(*file_ops, lseek(fd, _, _)).WillRepeatedly(Return(true));
-    EXPECT_CALL(*file_ops, read(fd, _, _))
-        .WillRepeatedly([&given_data, r = 0](int, void* buf, size_t count) mutable {
-            ::memcpy(buf, given_data.c_str() + r, count);
-            r += count;
-            return count;
+    EXPECT_CALL(*file_ops, lseek).Times(0);
+    EXPECT_CALL(*file_ops, pread(fd, _, given_data.size(), 0))
+        .WillOnce([&given_data](int, void* buf, size_t count, off_t) {
+            ::memcpy(buf, given_data.c_str(), count);
+            return static_cast<int>(count);
         });
 
     REPLACE(sftp_handle, [&named_fd](auto...) { return (void*)&named_fd; });
@@ -2670,15 +2766,14 @@ TEST_F(SftpServer, handlesReads)
     ASSERT_EQ(num_calls, 1);
 }
 
-TEST_F(SftpServer, readCannotSeekFails)
+TEST_F(SftpServer, readReturnsFailureFails)
 {
     mpt::TempDir temp_dir;
 
     std::string given_data{"some text"};
-    const int seek_pos{10};
     auto init_msg = make_msg(SSH_FXP_INIT);
     auto read_msg = make_msg(SFTP_READ);
-    read_msg->offset = seek_pos;
+    read_msg->offset = 0;
     read_msg->len = given_data.size();
 
     const auto path = mp::fs::path{temp_dir.path().toStdString()} / "test-file";
@@ -2686,7 +2781,7 @@ TEST_F(SftpServer, readCannotSeekFails)
     const auto named_fd = std::make_pair(path, fd);
 
     const auto [file_ops, mock_file_ops_guard] = mpt::MockFileOps::inject();
-    EXPECT_CALL(*file_ops, lseek(fd, _, _)).WillRepeatedly(Return(-1));
+    EXPECT_CALL(*file_ops, pread(fd, _, _, _)).WillOnce(Return(-1));
 
     REPLACE(sftp_handle, [&named_fd](auto...) { return (void*)&named_fd; });
     REPLACE(sftp_get_client_message, make_msg_handler());
@@ -2698,79 +2793,201 @@ TEST_F(SftpServer, readCannotSeekFails)
 
     screen_logs_trace();
     EXPECT_CALL(*logger_scope.mock_logger,
-                log(mpl::Level::trace,
+                log(Eq(mpl::Level::trace),
                     StrEq("sftp server"),
-                    AllOf(HasSubstr(fmt::format("cannot seek to position {} in", seek_pos)),
-                          HasSubstr(path.string()))));
+                    AllOf(HasSubstr("read failed for"), HasSubstr(path.string()))));
 
     sftp.run();
 
     EXPECT_EQ(failure_num_calls, 1);
 }
 
-TEST_F(SftpServer, readReturnsFailureFails)
+TEST_F(SftpServer, readReturnsZeroEndOfFile)
 {
     mpt::TempDir temp_dir;
 
-    std::string given_data{"some text"};
     auto init_msg = make_msg(SSH_FXP_INIT);
     auto read_msg = make_msg(SFTP_READ);
     read_msg->offset = 0;
-    read_msg->len = given_data.size();
+    read_msg->len = 10;
 
     const auto path = mp::fs::path{temp_dir.path().toStdString()} / "test-file";
     const auto fd = 123;
     const auto named_fd = std::make_pair(path, fd);
 
     const auto [file_ops, mock_file_ops_guard] = mpt::MockFileOps::inject();
-    EXPECT_CALL(*file_ops, lseek(fd, _, _)).WillRepeatedly(Return(true));
-    EXPECT_CALL(*file_ops, read(fd, _, _)).WillOnce(Return(-1));
+    EXPECT_CALL(*file_ops, pread(fd, _, _, _)).WillOnce(Return(0));
 
     REPLACE(sftp_handle, [&named_fd](auto...) { return (void*)&named_fd; });
     REPLACE(sftp_get_client_message, make_msg_handler());
-    int failure_num_calls{0};
-    REPLACE(sftp_reply_status,
-            make_reply_status(read_msg.get(), SSH_FX_FAILURE, failure_num_calls));
+    int eof_num_calls{0};
+    REPLACE(sftp_reply_status, make_reply_status(read_msg.get(), SSH_FX_EOF, eof_num_calls));
 
     auto sftp = make_sftpserver(temp_dir.path().toStdString());
+    sftp.run();
 
-    screen_logs_trace();
-    EXPECT_CALL(*logger_scope.mock_logger,
-                log(Eq(mpl::Level::trace),
-                    StrEq("sftp server"),
-                    AllOf(HasSubstr("read failed for"), HasSubstr(path.string()))));
+    EXPECT_EQ(eof_num_calls, 1);
+}
+
+TEST_F(SftpServer, sequentialReadsAreServedFromReadAhead)
+{
+    mpt::TempDir temp_dir;
+
+    const std::string given_data(256 * 1024, 'x');
+    const uint32_t chunk_size = 1000;
+    auto init_msg = make_msg(SSH_FXP_INIT);
+    std::vector<std::unique_ptr<sftp_client_message_struct>> read_msgs;
+    for (uint64_t offset = 0; offset < 3 * chunk_size; offset += chunk_size)
+    {
+        auto& read_msg = read_msgs.emplace_back(make_msg(SFTP_READ));
+        read_msg->offset = offset;
+        read_msg->len = chunk_size;
+    }
+
+    const auto path = mp::fs::path{temp_dir.path().toStdString()} / "test-file";
+    const auto fd = 123;
+    const auto named_fd = std::make_pair(path, fd);
+
+    const auto [file_ops, mock_file_ops_guard] = mpt::MockFileOps::inject();
+    EXPECT_CALL(*file_ops, pread(fd, _, _, _))
+        .Times(2)
+        .WillRepeatedly([&given_data](int, void* buf, size_t count, off_t offset) {
+            const auto r = std::min(count, given_data.size() - offset);
+            ::memcpy(buf, given_data.c_str() + offset, r);
+            return static_cast<int>(r);
+        });
 
+    REPLACE(sftp_handle, [&named_fd](auto...) { return (void*)&named_fd; });
+    REPLACE(sftp_get_client_message, make_msg_handler());
+
+    int num_calls{0};
+    auto reply_data = [&](sftp_client_message msg, const void* data, int len) {
+        EXPECT_EQ(msg, read_msgs[num_calls].get());
+        EXPECT_EQ(static_cast<uint32_t>(len), chunk_size);
+        EXPECT_EQ(std::string(reinterpret_cast<const char*>(data), len),
+                  given_data.substr(msg->offset, len));
+        ++num_calls;
+        return SSH_OK;
+    };
+    REPLACE(sftp_reply_data, reply_data);
+
+    auto sftp = make_sftpserver(temp_dir.path().toStdString());
     sftp.run();
 
-    EXPECT_EQ(failure_num_calls, 1);
+    EXPECT_EQ(num_calls, 3);
 }
 
-TEST_F(SftpServer, readReturnsZeroEndOfFile)
+TEST_F(SftpServer, writeDiscardsReadAhead)
 {
     mpt::TempDir temp_dir;
 
+    std::string given_data(4096, 'x');
     auto init_msg = make_msg(SSH_FXP_INIT);
-    auto read_msg = make_msg(SFTP_READ);
-    read_msg->offset = 0;
-    read_msg->len = 10;
+    auto read_msg1 = make_msg(SFTP_READ);
+    read_msg1->offset = 0;
+    read_msg1->len = 10;
+    auto read_msg2 = make_msg(SFTP_READ);
+    read_msg2->offset = 10;
+    read_msg2->len = 10;
+    auto write_msg = make_msg(SFTP_WRITE);
+    auto write_data = make_data("the answer");
+    write_msg->data = write_data.get();
+    write_msg->offset = 20;
+    auto read_msg3 = make_msg(SFTP_READ);
+    read_msg3->offset = 20;
+    read_msg3->len = 10;
 
     const auto path = mp::fs::path{temp_dir.path().toStdString()} / "test-file";
     const auto fd = 123;
     const auto named_fd = std::make_pair(path, fd);
 
+    off_t position{0};
     const auto [file_ops, mock_file_ops_guard] = mpt::MockFileOps::inject();
-    EXPECT_CALL(*file_ops, lseek(fd, _, _)).WillRepeatedly(Return(true));
-    EXPECT_CALL(*file_ops, read(fd, _, _)).WillOnce(Return(0));
+    EXPECT_CALL(*file_ops, lseek(fd, _, SEEK_SET)).WillRepeatedly([&position](int, off_t o, int) {
+        return position = o;
+    });
+    EXPECT_CALL(*file_ops, pread(fd, _, _, _))
+        .WillRepeatedly([&given_data](int, void* buf, size_t count, off_t offset) {
+            const auto r = std::min(count, given_data.size() - offset);
+            ::memcpy(buf, given_data.c_str() + offset, r);
+            return static_cast<int>(r);
+        });
+    EXPECT_CALL(*file_ops, write(fd, _, _))
+        .WillOnce([&given_data, &position](int, const void* buf, size_t nbytes) {
+            given_data.replace(position, nbytes, static_cast<const char*>(buf), nbytes);
+            return static_cast<int>(nbytes);
+        });
 
     REPLACE(sftp_handle, [&named_fd](auto...) { return (void*)&named_fd; });
     REPLACE(sftp_get_client_message, make_msg_handler());
-    int eof_num_calls{0};
-    REPLACE(sftp_reply_status, make_reply_status(read_msg.get(), SSH_FX_EOF, eof_num_calls));
+    REPLACE(sftp_reply_status, [](auto...) { return SSH_OK; });
+
+    std::string last_read;
+    REPLACE(sftp_reply_data, [&last_read](auto, const void* data, int len) {
+        last_read.assign(static_cast<const char*>(data), len);
+        return SSH_OK;
+    });
 
     auto sftp = make_sftpserver(temp_dir.path().toStdString());
     sftp.run();
 
-    EXPECT_EQ(eof_num_calls, 1);
+    EXPECT_EQ(last_read, "the answer");
+}
+
+TEST_F(SftpServer, readAheadIsReadAgainWhenFileChanges)
+{
+    mpt::TempDir temp_dir;
+
+    std::string given_data(4096, 'x');
+    auto init_msg = make_msg(SSH_FXP_INIT);
+    std::vector<std::unique_ptr<sftp_client_message_struct>> read_msgs;
+    for (uint64_t offset = 0; offset < 30; offset += 10)
+    {
+        auto& read_msg = read_msgs.emplace_back(make_msg(SFTP_READ));
+        read_msg->offset = offset;
+        read_msg->len = 10;
+    }
+
+    const auto path = mp::fs::path{temp_dir.path().toStdString()} / "test-file";
+    const auto fd = 123;
+    const auto named_fd = std::make_pair(path, fd);
+
+    time_t mtime{1};
+    const auto [file_ops, mock_file_ops_guard] = mpt::MockFileOps::inject();
+    EXPECT_CALL(*file_ops, fstat(fd, _))
+        .WillRepeatedly([&given_data, &mtime](int, struct stat* st) {
+            st->st_size = given_data.size();
+            st->st_mtime = mtime;
+            return 0;
+        });
+    EXPECT_CALL(*file_ops, pread(fd, _, _, _))
+        .Times(3) // a plain read, a read ahead and, once the file changed, another read ahead
+        .WillRepeatedly([&given_data](int, void* buf, size_t count, off_t offset) {
+            const auto r = std::min(count, given_data.size() - offset);
+            ::memcpy(buf, given_data.c_str() + offset, r);
+            return static_cast<int>(r);
+        });
+
+    REPLACE(sftp_handle, [&named_fd](auto...) { return (void*)&named_fd; });
+    REPLACE(sftp_get_client_message, make_msg_handler());
+
+    std::string last_read;
+    int num_calls{0};
+    REPLACE(sftp_reply_data, [&](auto, const void* data, int len) {
+        last_read.assign(static_cast<const char*>(data), len);
+        if (++num_calls == 2) // edited on the host, after the second read filled the read ahead
+        {
+            given_data.assign(given_data.size(), 'y');
+            ++mtime;
+        }
+        return SSH_OK;
+    });
+
+    auto sftp = make_sftpserver(temp_dir.path().toStdString());
+    sftp.run();
+
+    EXPECT_EQ(num_calls, 3);
+    EXPECT_EQ(last_read, std::string(10, 'y'));
 }
 
 TEST_F(SftpServer, handleExtendedLink)
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common.h"
+
+#include <multipass/thread_pool.h>
+#include <multipass/utils.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mpt = multipass::test;
+namespace mpu = multipass::utils;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+TEST(ThreadPool, runsSubmittedTasks)
+{
+    mpu::ThreadPool pool{2};
+    EXPECT_EQ(pool.size(), 2u);
+
+    std::promise<std::thread::id> ran_on;
+    pool.submit([&ran_on] { ran_on.set_value(std::this_thread::get_id()); });
+
+    auto future = ran_on.get_future();
+    ASSERT_EQ(future.wait_for(5s), std::future_status::ready);
+    EXPECT_NE(future.get(), std::this_thread::get_id());
+}
+
+TEST(ThreadPool, survivesThrowingTasks)
+{
+    mpu::ThreadPool pool{1};
+    std::promise<void> ran;
+
+    pool.submit([] { throw std::runtime_error{"oops"}; });
+    pool.submit([&ran] { ran.set_value(); });
+
+    EXPECT_EQ(ran.get_future().wait_for(5s), std::future_status::ready);
+}
+
+TEST(ParallelFor, visitsEveryIndexOnce)
+{
+    constexpr auto count = 100u;
+    std::vector<std::atomic_int> visits(count);
+
+    mpu::parallel_for(count, [&visits](std::size_t i) { ++visits[i]; });
+
+    for (const auto& v : visits)
+        EXPECT_EQ(v, 1);
+}
+
+TEST(ParallelFor, respectsMaxConcurrency)
+{
+    std::atomic_int running{0}, max_running{0};
+
+    mpu::parallel_for(
+        16,
+        [&running, &max_running](std::size_t) {
+            auto now_running = ++running;
+            for (auto seen = max_running.load(); now_running > seen;)
+                max_running.compare_exchange_weak(seen, now_running);
+
+            std::this_thread::sleep_for(2ms);
+            --running;
+        },
+        2);
+
+    EXPECT_THAT(max_running.load(), AllOf(Ge(1), Le(2)));
+}
+
+TEST(ParallelFor, runsRemainingWorkAndRethrowsFirstFailure)
+{
+    std::vector<std::size_t> visited;
+    auto op = [&visited](std::size_t i) {
+        visited.push_back(i);
+        if (i == 2 || i == 5)
+            throw std::runtime_error{std::to_string(i)};
+    };
+
+    // A single lane runs everything on the calling thread, in order
+    MP_EXPECT_THROW_THAT(mpu::parallel_for(7, op, 1),
+                         std::runtime_error,
+                         mpt::match_what(StrEq("2")));
+    EXPECT_THAT(visited, ElementsAre(0u, 1u, 2u, 3u, 4u, 5u, 6u));
+}
+
+TEST(ParallelFor, nestedCallsComplete)
+{
+    constexpr auto outer = 32u, inner = 32u;
+    std::atomic_uint total{0};
+
+    mpu::parallel_for(outer, [&total](std::size_t) {
+        mpu::parallel_for(inner, [&total](std::size_t) { ++total; });
+    });
+
+    EXPECT_EQ(total, outer * inner);
+}
+
+TEST(ParallelFor, doesNothingForNoWork)
+{
+    mpu::parallel_for(0, [](std::size_t) { FAIL() << "Not expected to run"; });
+}
+
+TEST(ParallelTransform, keepsInputOrderAndDropsDefaultResults)
+{
+    const std::vector<int> inputs{1, 2, 3, 4, 5, 6};
+    auto results = mpu::parallel_transform(inputs, [](int i) { return i % 3 ? i * 10 : 0; });
+
+    EXPECT_THAT(results, ElementsAre(10, 20, 40, 50));
+}
+
+TEST(ParallelForEach, visitsEveryElement)
+{
+    std::vector<int> items(50, 1);
+    mpu::parallel_for_each(items, [](int& item) { item *= 2; });
+
+    EXPECT_THAT(items, Each(2));
+}
+
+TEST(ParallelForEach, visitsEveryElementWhenTheFirstThrows)
+{
+    std::vector<int> items(50, 1);
+    auto op = [&items](int& item) {
+        if (&item == &items.front())
+            throw std::runtime_error{"first"};
+        item *= 2;
+    };
+
+    MP_EXPECT_THROW_THAT(mpu::parallel_for_each(items, op),
+                         std::runtime_error,
+                         mpt::match_what(StrEq("first")));
+    EXPECT_EQ(items.front(), 1);
+    EXPECT_THAT(std::vector(items.begin() + 1, items.end()), Each(2));
+}
+} // namespace
@@ -34,6 +34,8 @@
 #include <cstddef>
 #include <optional>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace mp = multipass;
 namespace mpt = multipass::test;
@@ -505,6 +507,55 @@ TEST_F(UbuntuImageHost, infoForFullHashFindsImage)
     EXPECT_EQ(image_info.release, "zesty");
 }
 
+TEST_F(UbuntuImageHost, lookupsFollowRefreshedManifests)
+{
+    mp::UbuntuVMImageHost host{all_remote_specs, &url_downloader};
+    host.update_manifests(false);
+    host.update_manifests(true);
+
+    const auto full_hash = "ab115b83e7a8bebf3d3a02bf55ad0cb75a0ed515fcbc65fb0c9abe76c752921c";
+    EXPECT_EQ(host.info_for_full_hash(full_hash).release, "zesty");
+
+    auto info = host.info_for(make_query("ab115b", release_remote_spec.first));
+    ASSERT_TRUE(info);
+    EXPECT_EQ(info->id, full_hash);
+}
+
+TEST_F(UbuntuImageHost, reusesParsedManifestsWhenDownloadsAreUnchanged)
+{
+    mp::UbuntuVMImageHost host{{release_remote_spec}, &url_downloader};
+
+    std::vector<const mp::VMImageInfo*> entries;
+    auto action = [&entries](const std::string& /*remote*/, const mp::VMImageInfo& info) {
+        entries.push_back(&info);
+    };
+
+    host.update_manifests(false);
+    host.for_each_entry_do(action);
+    const auto first_entries = std::exchange(entries, {});
+
+    host.update_manifests(true);
+    host.for_each_entry_do(action);
+
+    ASSERT_FALSE(first_entries.empty());
+    EXPECT_EQ(entries, first_entries);
+}
+
+TEST_F(UbuntuImageHost, fetchesRemotesConcurrentlyAndDropsTheOnesThatFail)
+{
+    EXPECT_CALL(mock_settings, get(Eq(mp::mirror_key)))
+        .WillRepeatedly(Return(test_invalid_mirror_host));
+
+    mp::UbuntuVMImageHost host{{release_remote_spec_with_mirror_allowed, daily_remote_spec},
+                               &url_downloader};
+    host.update_manifests(false);
+
+    EXPECT_THROW(host.info_for(make_query("xenial", release_remote_spec.first)),
+                 std::runtime_error);
+    EXPECT_TRUE(host.info_for(make_query("xenial", daily_remote_spec.first)));
+    EXPECT_THAT(mpt::count_remotes(host), Eq(1u));
+}
+
 TEST_F(UbuntuImageHost, unknownHashThrows)
 {
     const auto bad_hash = "1234";
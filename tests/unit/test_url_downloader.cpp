@@ -16,6 +16,7 @@
  */
 
 #include "common.h"
+#include "file_operations.h"
 #include "mock_file_ops.h"
 #include "mock_logger.h"
 #include "mock_network.h"
@@ -528,6 +529,149 @@ TEST_F(URLDownloader, fileDownloadWriteFailsLogsErrorAndThrows)
                  mp::AbortedDownloadException);
 }
 
+TEST_F(URLDownloader, fileDownloadResumesPartialDownload)
+{
+    const QByteArray downloaded_data{"This is some data "};
+    const QByteArray remaining_data{"to put in a file when downloaded."};
+    mpt::MockQNetworkReply* mock_reply = new mpt::MockQNetworkReply();
+
+    mpt::TempDir file_dir;
+    QString download_file{file_dir.path() + "/foo.txt"};
+    mpt::make_file_with_content(download_file + ".part", downloaded_data.toStdString());
+    mpt::make_file_with_content(download_file + ".part.validator", "\"an-etag\"");
+
+    QNetworkRequest sent_request;
+    EXPECT_CALL(*mock_network_access_manager, createRequest(_, _, _))
+        .WillOnce([&mock_reply, &sent_request](auto, const QNetworkRequest& request, auto) {
+            sent_request = request;
+            QTimer::singleShot(0, [&mock_reply] {
+                mock_reply->set_attribute(QNetworkRequest::HttpStatusCodeAttribute, 206);
+                mock_reply->readyRead();
+                mock_reply->finished();
+            });
+            return mock_reply;
+        });
+
+    EXPECT_CALL(*mock_reply, readData(_, _))
+        .WillOnce([&remaining_data](char* data, auto) {
+            memcpy(data, remaining_data.constData(), remaining_data.size());
+            return remaining_data.size();
+        })
+        .WillRepeatedly(Return(0));
+
+    logger_scope.mock_logger->screen_logs(mpl::Level::error);
+
+    mp::URLDownloader downloader(cache_dir.path(), 10ms);
+    downloader.download_to(fake_url, download_file, -1, -1, [](auto...) { return true; });
+
+    EXPECT_EQ(sent_request.rawHeader("Range"),
+              QByteArray("bytes=") + QByteArray::number(downloaded_data.size()) + "-");
+    EXPECT_EQ(sent_request.rawHeader("If-Range"), "\"an-etag\"");
+
+    QFile test_file{download_file};
+    ASSERT_TRUE(test_file.open(QIODevice::ReadOnly));
+    EXPECT_EQ(test_file.readAll(), downloaded_data + remaining_data);
+    EXPECT_FALSE(QFile::exists(download_file + ".part"));
+    EXPECT_FALSE(QFile::exists(download_file + ".part.validator"));
+}
+
+TEST_F(URLDownloader, fileDownloadReplacesPartialDownloadWhenRangeIgnored)
+{
+    const QByteArray test_data{"This is some data to put in a file when downloaded."};
+    mpt::MockQNetworkReply* mock_reply = new mpt::MockQNetworkReply();
+
+    mpt::TempDir file_dir;
+    QString download_file{file_dir.path() + "/foo.txt"};
+    mpt::make_file_with_content(download_file + ".part", "stale data");
+    mpt::make_file_with_content(download_file + ".part.validator", "\"an-etag\"");
+
+    EXPECT_CALL(*mock_network_access_manager, createRequest(_, _, _))
+        .WillOnce([&mock_reply](auto...) {
+            QTimer::singleShot(0, [&mock_reply] {
+                mock_reply->set_attribute(QNetworkRequest::HttpStatusCodeAttribute, 200);
+                mock_reply->readyRead();
+                mock_reply->finished();
+            });
+            return mock_reply;
+        });
+
+    EXPECT_CALL(*mock_reply, readData(_, _))
+        .WillOnce([&test_data](char* data, auto) {
+            memcpy(data, test_data.constData(), test_data.size());
+            return test_data.size();
+        })
+        .WillRepeatedly(Return(0));
+
+    logger_scope.mock_logger->screen_logs(mpl::Level::error);
+
+    mp::URLDownloader downloader(cache_dir.path(), 10ms);
+    downloader.download_to(fake_url, download_file, -1, -1, [](auto...) { return true; });
+
+    QFile test_file{download_file};
+    ASSERT_TRUE(test_file.open(QIODevice::ReadOnly));
+    EXPECT_EQ(test_file.readAll(), test_data);
+}
+
+TEST_F(URLDownloader, fileDownloadRestartsWhenResumeIsRejected)
+{
+    const QByteArray test_data{"This is some data to put in a file when downloaded."};
+    mpt::MockQNetworkReply* mock_reply_rejected = new mpt::MockQNetworkReply();
+    mpt::MockQNetworkReply* mock_reply_full = new mpt::MockQNetworkReply();
+
+    mpt::TempDir file_dir;
+    QString download_file{file_dir.path() + "/foo.txt"};
+    mpt::make_file_with_content(download_file + ".part", "already complete data");
+    mpt::make_file_with_content(download_file + ".part.validator", "\"an-etag\"");
+
+    std::vector<QNetworkRequest> sent_requests;
+    EXPECT_CALL(*mock_network_access_manager, createRequest(_, _, _))
+        .WillOnce([&](auto, const QNetworkRequest& request, auto) {
+            sent_requests.push_back(request);
+            QTimer::singleShot(0, [&mock_reply_rejected] {
+                mock_reply_rejected->set_attribute(QNetworkRequest::HttpStatusCodeAttribute, 416);
+                mock_reply_rejected->set_error(QNetworkReply::UnknownContentError,
+                                               "Range Not Satisfiable");
+                mock_reply_rejected->readyRead();
+                mock_reply_rejected->finished();
+            });
+            return mock_reply_rejected;
+        })
+        .WillOnce([&](auto, const QNetworkRequest& request, auto) {
+            sent_requests.push_back(request);
+            QTimer::singleShot(0, [&mock_reply_full] {
+                mock_reply_full->set_attribute(QNetworkRequest::HttpStatusCodeAttribute, 200);
+                mock_reply_full->readyRead();
+                mock_reply_full->finished();
+            });
+            return mock_reply_full;
+        });
+
+    EXPECT_CALL(*mock_reply_rejected, readData(_, _)).WillRepeatedly(Return(0));
+    EXPECT_CALL(*mock_reply_full, readData(_, _))
+        .WillOnce([&test_data](char* data, auto) {
+            memcpy(data, test_data.constData(), test_data.size());
+            return test_data.size();
+        })
+        .WillRepeatedly(Return(0));
+
+    logger_scope.mock_logger->screen_logs(mpl::Level::warning);
+    logger_scope.mock_logger->expect_log(mpl::Level::warning, "Cannot resume download");
+
+    mp::URLDownloader downloader(cache_dir.path(), 10ms);
+    downloader.download_to(fake_url, download_file, -1, -1, [](auto...) { return true; });
+
+    ASSERT_EQ(sent_requests.size(), 2u);
+    EXPECT_TRUE(sent_requests[0].hasRawHeader("Range"));
+    EXPECT_FALSE(sent_requests[1].hasRawHeader("Range"));
+    EXPECT_FALSE(sent_requests[1].hasRawHeader("If-Range"));
+
+    QFile test_file{download_file};
+    ASSERT_TRUE(test_file.open(QIODevice::ReadOnly));
+    EXPECT_EQ(test_file.readAll(), test_data);
+    EXPECT_FALSE(QFile::exists(download_file + ".part"));
+    EXPECT_FALSE(QFile::exists(download_file + ".part.validator"));
+}
+
 TEST_F(URLDownloader, lastModifiedHeaderReturnsExpectedData)
 {
     const QDateTime date_time{QDateTime::currentDateTimeUtc()};
@@ -57,6 +57,74 @@ void create_test_xz_file(const std::filesystem::path& path)
     f.close();
 }
 
+// Decodes to more data than the decoder buffers at once, so output goes through several writes
+void create_large_test_xz_file(const std::filesystem::path& path)
+{
+    std::ofstream f(path, std::ios::binary);
+    ASSERT_TRUE(f.is_open());
+
+    // Auto-generated from xz - DO NOT EDIT
+    // head -c 4194305 /dev/zero > zeros.img
+    // xz -k -c --check=crc32 --lzma2=preset=9e,dict=8MiB zeros.img > zeros.img.xz
+    // xxd -i zeros.img.xz > zeros_xz_bytes.h
+    unsigned char zeros_img_xz[] = {
+        0xfd, 0x37, 0x7a, 0x58, 0x5a, 0x00, 0x00, 0x01, 0x69, 0x22, 0xde, 0x36, 0x04, 0xc0, 0xb0,
+        0x05, 0x81, 0x80, 0x80, 0x02, 0x21, 0x01, 0x16, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3c, 0x2b,
+        0x28, 0x8b, 0xff, 0xff, 0x11, 0x01, 0x6c, 0x5d, 0x00, 0x00, 0x6f, 0xfd, 0xff, 0xff, 0xa3,
+        0xb7, 0xff, 0x47, 0x3e, 0x48, 0x15, 0x72, 0x39, 0x61, 0x51, 0xb8, 0x92, 0x28, 0xe6, 0xa3,
+        0x86, 0x07, 0xf9, 0xee, 0xe4, 0x1e, 0x82, 0xd3, 0x2f, 0xc5, 0x3a, 0x3c, 0x01, 0x4b, 0xb1,
+        0x7e, 0xc9, 0x8a, 0x8a, 0x4d, 0x2f, 0xa3, 0x0d, 0xd9, 0x7f, 0xa6, 0xe3, 0x8c, 0x23, 0x11,
+        0x53, 0xe0, 0x59, 0x18, 0xc5, 0x75, 0x8a, 0xe2, 0x77, 0xf8, 0xb6, 0x94, 0x7f, 0x0c, 0x6a,
+        0xc0, 0xde, 0x74, 0x49, 0x64, 0xe2, 0xe9, 0x5c, 0x53, 0xb2, 0x04, 0xd8, 0xf7, 0x44, 0x0c,
+        0xab, 0x5f, 0x0d, 0x6d, 0x46, 0xe9, 0xe5, 0xc3, 0x76, 0x88, 0xb7, 0x96, 0x57, 0xac, 0xb6,
+        0x4d, 0xe1, 0x69, 0x1d, 0x6f, 0xfb, 0x4b, 0x88, 0x10, 0x6c, 0x42, 0xcb, 0x88, 0x3f, 0x5c,
+        0x00, 0x8f, 0xd0, 0x4e, 0xaf, 0x26, 0x28, 0x94, 0x71, 0x1f, 0x3d, 0x8f, 0x24, 0xe1, 0x70,
+        0x9e, 0xa7, 0x23, 0x5f, 0xec, 0x28, 0xcb, 0x85, 0xd1, 0x95, 0x98, 0x8a, 0x7e, 0x2a, 0x91,
+        0xf2, 0x27, 0x75, 0xf7, 0x19, 0xc0, 0x06, 0x98, 0x4d, 0x98, 0xfd, 0xd8, 0xaf, 0xd5, 0x90,
+        0x0f, 0xc4, 0x25, 0x53, 0xf8, 0xf5, 0x91, 0x36, 0x31, 0x05, 0xa5, 0xb0, 0xee, 0x6f, 0xc1,
+        0x70, 0x4d, 0x47, 0x0c, 0xd1, 0x91, 0x11, 0xaa, 0xad, 0x60, 0x1d, 0xba, 0xce, 0xb1, 0x27,
+        0x18, 0x5c, 0x59, 0x86, 0xe9, 0x66, 0x52, 0x58, 0xbe, 0xe9, 0x76, 0xac, 0x59, 0xe4, 0xe5,
+        0x5b, 0x05, 0x08, 0xf9, 0xc7, 0xda, 0xad, 0xfc, 0xfb, 0x52, 0x2b, 0x74, 0xcd, 0x1e, 0x5b,
+        0x20, 0x42, 0xf9, 0xdd, 0x53, 0x3d, 0xf8, 0x29, 0x64, 0x09, 0x3b, 0x80, 0xcb, 0x2a, 0x6c,
+        0xdf, 0xb5, 0x3b, 0xf0, 0xc4, 0xbd, 0x2e, 0x5f, 0xaa, 0x0f, 0x3e, 0x4b, 0x66, 0x42, 0x90,
+        0x13, 0x0e, 0xff, 0x10, 0x93, 0xf8, 0x71, 0x78, 0x59, 0xf8, 0x0b, 0xcd, 0xff, 0x95, 0x28,
+        0x46, 0x0f, 0xa9, 0xfc, 0x7c, 0xde, 0xfb, 0x9a, 0x30, 0x2e, 0x56, 0xc0, 0x8f, 0x85, 0xf3,
+        0x83, 0x81, 0xc0, 0x65, 0xc4, 0x25, 0x53, 0xf8, 0xf5, 0x91, 0x36, 0x31, 0x05, 0xa5, 0xb0,
+        0xee, 0x6f, 0xc1, 0x70, 0x4d, 0x47, 0x0c, 0xd1, 0x91, 0x11, 0xaa, 0xad, 0x60, 0x1d, 0xba,
+        0xce, 0xb1, 0x27, 0x18, 0x5c, 0x59, 0x86, 0xe9, 0x66, 0x52, 0x58, 0xbe, 0xe9, 0x76, 0xac,
+        0x59, 0xe4, 0xe5, 0x5b, 0x05, 0x08, 0xf9, 0xc7, 0xda, 0xad, 0xfc, 0xfb, 0x52, 0x2b, 0x74,
+        0xcd, 0x1e, 0x5b, 0x20, 0x42, 0xf9, 0xdd, 0x53, 0x3d, 0xf8, 0x29, 0x64, 0x09, 0x3b, 0x80,
+        0xcb, 0x2a, 0x6c, 0xdf, 0xb5, 0x3b, 0xf0, 0xc4, 0xbc, 0x48, 0x27, 0xe6, 0x58, 0x9f, 0xff,
+        0x10, 0x01, 0x2b, 0x00, 0xec, 0x73, 0x53, 0xa7, 0xfd, 0xbe, 0xae, 0x7c, 0x31, 0x1a, 0x9f,
+        0xb7, 0x8d, 0x31, 0x6e, 0x70, 0x9e, 0xa7, 0x23, 0x5f, 0xec, 0x28, 0xcb, 0x85, 0xd1, 0x95,
+        0x98, 0x8a, 0x7e, 0x2a, 0x91, 0xf2, 0x27, 0x75, 0xf7, 0x19, 0xc0, 0x06, 0x98, 0x4d, 0x98,
+        0xfd, 0xd8, 0xaf, 0xd5, 0x90, 0x0f, 0xc4, 0x25, 0x53, 0xf8, 0xf5, 0x91, 0x36, 0x31, 0x05,
+        0xa5, 0xb0, 0xee, 0x6f, 0xc1, 0x70, 0x4d, 0x47, 0x0c, 0xd1, 0x91, 0x11, 0xaa, 0xad, 0x60,
+        0x1d, 0xba, 0xce, 0xb1, 0x27, 0x18, 0x5c, 0x59, 0x86, 0xe9, 0x66, 0x52, 0x58, 0xbe, 0xe9,
+        0x76, 0xac, 0x59, 0xe4, 0xe5, 0x5b, 0x05, 0x08, 0xf9, 0xc7, 0xda, 0xad, 0xfc, 0xfb, 0x52,
+        0x2b, 0x74, 0xcd, 0x1e, 0x5b, 0x20, 0x42, 0xf9, 0xdd, 0x53, 0x3d, 0xf8, 0x29, 0x64, 0x09,
+        0x3b, 0x80, 0xcb, 0x2a, 0x6c, 0xdf, 0xb5, 0x3b, 0xf0, 0xc4, 0xbd, 0x2e, 0x5f, 0xaa, 0x0f,
+        0x3e, 0x4b, 0x66, 0x42, 0x90, 0x13, 0x0e, 0xff, 0x10, 0x93, 0xf8, 0x71, 0x78, 0x59, 0xf8,
+        0x0b, 0xcd, 0xff, 0x95, 0x28, 0x46, 0x0f, 0xa9, 0xfc, 0x7c, 0xde, 0xfb, 0x9a, 0x30, 0x2e,
+        0x56, 0xc0, 0x8f, 0x85, 0xf3, 0x83, 0x81, 0xc0, 0x65, 0xc4, 0x25, 0x53, 0xf8, 0xf5, 0x91,
+        0x36, 0x31, 0x05, 0xa5, 0xb0, 0xee, 0x6f, 0xc1, 0x70, 0x4d, 0x47, 0x0c, 0xd1, 0x91, 0x11,
+        0xaa, 0xad, 0x60, 0x1d, 0xba, 0xce, 0xb1, 0x27, 0x18, 0x5c, 0x59, 0x86, 0xe9, 0x66, 0x52,
+        0x58, 0xbe, 0xe9, 0x76, 0xac, 0x59, 0xe4, 0xe5, 0x5b, 0x05, 0x08, 0xf9, 0xc7, 0xda, 0xad,
+        0xfc, 0xfb, 0x52, 0x2b, 0x74, 0xcd, 0x1e, 0x5b, 0x20, 0x42, 0xf9, 0xdd, 0x53, 0x3d, 0xf8,
+        0x29, 0x64, 0x09, 0x3b, 0x80, 0xcb, 0x2a, 0x6c, 0xdf, 0xb5, 0x3b, 0xf0, 0xc4, 0xbd, 0x2e,
+        0x5f, 0xaa, 0x0f, 0x3e, 0x4b, 0x66, 0x42, 0x90, 0x13, 0x0e, 0xff, 0x10, 0x93, 0xf8, 0x71,
+        0x78, 0x59, 0xf8, 0x0b, 0xcd, 0xff, 0x95, 0x28, 0x46, 0x0f, 0xa9, 0xfc, 0x7c, 0xde, 0xfb,
+        0x9a, 0x30, 0x2e, 0x56, 0xc0, 0x8f, 0x85, 0xf3, 0x83, 0x81, 0xc0, 0x65, 0xc4, 0x25, 0x51,
+        0x0f, 0x3f, 0xb2, 0x80, 0x01, 0xdd, 0x00, 0x05, 0x00, 0x41, 0xf5, 0xe6, 0xe1, 0x00, 0x00,
+        0x8b, 0x20, 0x74, 0x7f, 0x00, 0x01, 0xc8, 0x05, 0x81, 0x80, 0x80, 0x02, 0xcd, 0xf4, 0x53,
+        0x97, 0x3e, 0x30, 0x0d, 0x8b, 0x02, 0x00, 0x00, 0x00, 0x00, 0x01, 0x59, 0x5a};
+    unsigned int zeros_img_xz_len = 748;
+    // End auto-generated section
+
+    f.write(reinterpret_cast<const char*>(zeros_img_xz), zeros_img_xz_len);
+    f.close();
+}
+
 void create_invalid_xz_file(const std::filesystem::path& output_path)
 {
     std::ofstream xz_file{output_path, std::ios::binary | std::ios::out};
@@ -203,3 +271,24 @@ TEST_F(XzImageDecoder, outputFileHasExpectedContent)
 
     EXPECT_EQ(output_content, sample_content);
 }
+
+TEST_F(XzImageDecoder, outputLargerThanWriteBufferIsComplete)
+{
+    create_large_test_xz_file(xz_file_path);
+    MockProgressMonitor monitor;
+
+    EXPECT_CALL(monitor, call(_, _)).Times(AtLeast(0));
+
+    decoder.decode_to(xz_file_path, output_file_path, monitor.get_monitor());
+
+    std::ifstream output_file{output_file_path, std::ios::binary};
+    ASSERT_TRUE(output_file.is_open());
+
+    std::string output_content((std::istreambuf_iterator<char>(output_file)),
+                               std::istreambuf_iterator<char>());
+
+    EXPECT_EQ(output_content.size(), 4194305u);
+    EXPECT_TRUE(std::all_of(output_content.begin(), output_content.end(), [](char c) {
+        return c == '\0';
+    }));
+}